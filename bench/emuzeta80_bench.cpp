@@ -0,0 +1,867 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file emuzeta80_bench.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Micro and macro benchmarks for the Z80 emulator
+ *
+ * Run with --benchmark_format=json (or build the bench_json target) to get
+ * machine readable results. Every CPU benchmark reports a MIPS counter.
+ *
+ * With --emuzeta80_baseline=<results.json> (the JSON results of another
+ * build, e.g. without LTO or PGO) the benchmarks also report their speedup
+ * over the MIPS of the baseline.
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CPU.h"
+#include "Debugger.h"
+#include "Farm.h"
+#include "Fusion.h"
+#include "Lockstep.h"
+#include "Scheduler.h"
+#include "Traps.h"
+
+using namespace emuzeta80;
+
+// Build of the library (set by CMake for emuzeta80_bench and emuzeta80_bench_unity)
+#ifndef EMUZETA80_BENCH_LIBRARY
+#define EMUZETA80_BENCH_LIBRARY "shared"
+#endif
+#ifndef EMUZETA80_BENCH_OPTIONS
+#define EMUZETA80_BENCH_OPTIONS ""
+#endif
+
+//-------------------------------------------------------------------------
+// Helpers
+//-------------------------------------------------------------------------
+
+namespace
+{
+
+const uint64_t RAM_SIZE = 0x10000;
+
+/**
+ * @brief Add the build of the library to the context of the results
+ *
+ * The results of the builds (shared or unity, LTO, PGO) can be compared
+ * with the compare.py tool of Google Benchmark.
+ */
+bool addBuildContext()
+{
+    benchmark::AddCustomContext("emuzeta80_library", EMUZETA80_BENCH_LIBRARY);
+    benchmark::AddCustomContext("emuzeta80_options", EMUZETA80_BENCH_OPTIONS);
+    return true;
+}
+
+const bool buildContext = addBuildContext();
+
+/**
+ * @brief Copy a program into the memory of a CPU
+ *
+ * @param cpu target CPU
+ * @param program bytes of the program
+ * @param address memory address where the first byte is written
+ */
+template<class T>
+void load(T& cpu, const std::vector<uint8_t>& program, uint16_t address = 0)
+{
+    for(size_t i = 0; i < program.size(); i++)
+        cpu.memory->poke(address + i, program[i]);
+}
+
+/**
+ * @brief Execute instructions until PC reaches the given address
+ *
+ * @return number of executed instructions
+ */
+template<class T>
+uint64_t runUntil(T& cpu, uint16_t address)
+{
+    uint64_t instructions = 0;
+    while(cpu.getpc() != address)
+    {
+        cpu.execute();
+        instructions++;
+    }
+
+    return instructions;
+}
+
+/**
+ * @brief Report executed instructions as a MIPS rate
+ */
+void setMIPS(benchmark::State& state, uint64_t instructions)
+{
+    state.counters["MIPS"] = benchmark::Counter(instructions / 1e6, benchmark::Counter::kIsRate);
+    state.SetItemsProcessed(instructions);
+}
+
+/**
+ * @brief Build a block of instructions repeated up to 1 KiB and closed with JP 0000h
+ *
+ * The instructions of the block must not modify the program counter.
+ */
+std::vector<uint8_t> buildMix(const std::vector<uint8_t>& block)
+{
+    std::vector<uint8_t> program;
+    while(program.size() + block.size() <= 1024)
+        program.insert(program.end(), block.begin(), block.end());
+
+    program.push_back(0xC3); // JP 0000h
+    program.push_back(0x00);
+    program.push_back(0x00);
+
+    return program;
+}
+
+// Sieve of Eratosthenes over 8 KiB of flags at 4000h, stops at HALT
+const uint16_t SIEVE_FLAGS = 0x4000;
+const uint16_t SIEVE_SIZE = 0x2000;
+const std::vector<uint8_t> SIEVE_PROGRAM = {
+    0x21, 0x00, 0x40, // 0000: LD HL, 4000h
+    0x01, 0x00, 0x20, // 0003: LD BC, 2000h
+    0x36, 0x01,       // 0006: LD (HL), 1
+    0x23,             // 0008: INC HL
+    0x0B,             // 0009: DEC BC
+    0x78,             // 000A: LD A, B
+    0xB1,             // 000B: OR C
+    0xC2, 0x06, 0x00, // 000C: JP NZ, 0006h
+    0x11, 0x02, 0x00, // 000F: LD DE, 2
+    0x21, 0x00, 0x40, // 0012: LD HL, 4000h
+    0x19,             // 0015: ADD HL, DE
+    0x7E,             // 0016: LD A, (HL)
+    0xB7,             // 0017: OR A
+    0xCA, 0x27, 0x00, // 0018: JP Z, 0027h
+    0x19,             // 001B: ADD HL, DE
+    0x7C,             // 001C: LD A, H
+    0xFE, 0x60,       // 001D: CP 60h
+    0xD2, 0x27, 0x00, // 001F: JP NC, 0027h
+    0x36, 0x00,       // 0022: LD (HL), 0
+    0xC3, 0x1B, 0x00, // 0024: JP 001Bh
+    0x13,             // 0027: INC DE
+    0x7A,             // 0028: LD A, D
+    0xFE, 0x20,       // 0029: CP 20h
+    0xDA, 0x12, 0x00, // 002B: JP C, 0012h
+    0x76              // 002E: HALT
+};
+const uint16_t SIEVE_END = 0x002F;
+
+/**
+ * @brief Build a CRC-16/CCITT (poly 1021h, init FFFFh) program over [start, end)
+ *
+ * Registers: HL = crc, DE = pointer, BC = polynomial. The loop over the 8 bits
+ * of each byte is unrolled. The program stops after the HALT instruction.
+ */
+std::vector<uint8_t> buildCRCProgram(uint16_t start, uint16_t end)
+{
+    std::vector<uint8_t> program = {
+        0x21, 0xFF, 0xFF,                            // LD HL, FFFFh
+        0x11, (uint8_t)start, (uint8_t)(start >> 8), // LD DE, start
+        0x01, 0x21, 0x10                             // LD BC, 1021h
+    };
+
+    uint16_t loop = program.size();
+    program.insert(program.end(), {
+        0x1A, // LD A, (DE)
+        0xAC, // XOR H
+        0x67  // LD H, A
+    });
+
+    for(int bit = 0; bit < 8; bit++)
+    {
+        uint16_t skip = program.size() + 13;
+        program.insert(program.end(), {
+            0x7C,                                      // LD A, H
+            0xE6, 0x80,                                // AND 80h
+            0x29,                                      // ADD HL, HL
+            0xCA, (uint8_t)skip, (uint8_t)(skip >> 8), // JP Z, skip
+            0x7C,                                      // LD A, H
+            0xA8,                                      // XOR B
+            0x67,                                      // LD H, A
+            0x7D,                                      // LD A, L
+            0xA9,                                      // XOR C
+            0x6F                                       // LD L, A
+        });
+    }
+
+    program.insert(program.end(), {
+        0x13,                                      // INC DE
+        0x7B,                                      // LD A, E
+        0xFE, (uint8_t)end,                        // CP end (low)
+        0xC2, (uint8_t)loop, (uint8_t)(loop >> 8), // JP NZ, loop
+        0x7A,                                      // LD A, D
+        0xFE, (uint8_t)(end >> 8),                 // CP end (high)
+        0xC2, (uint8_t)loop, (uint8_t)(loop >> 8), // JP NZ, loop
+        0x76                                       // HALT
+    });
+
+    return program;
+}
+
+uint16_t crc16(const std::vector<uint8_t>& data)
+{
+    uint16_t crc = 0xFFFF;
+    for(auto byte : data)
+    {
+        crc ^= byte << 8;
+        for(int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
+
+} // namespace
+
+//-------------------------------------------------------------------------
+// Memory benchmarks
+//-------------------------------------------------------------------------
+
+static void BM_RAM_peek(benchmark::State& state)
+{
+    RAM ram(RAM_SIZE);
+    for(uint32_t address = 0; address < 0x400; address++)
+        ram.poke(address, (uint8_t)address);
+
+    uint16_t address = 0;
+    for(auto _ : state)
+    {
+        benchmark::DoNotOptimize(ram.peek(address));
+        address = (address + 1) & 0x3FF;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RAM_peek);
+
+// rom:1 marks half of the written pages as ROM (the dropped writes are counted)
+static void BM_RAM_poke(benchmark::State& state)
+{
+    RAM ram(RAM_SIZE);
+    if(state.range(0))
+        ram.protect(0x200, 0x200);
+
+    uint16_t address = 0;
+    for(auto _ : state)
+    {
+        ram.poke(address, (uint8_t)address);
+        address = (address + 1) & 0x3FF;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RAM_poke)->ArgName("rom")->Arg(0)->Arg(1);
+
+//-------------------------------------------------------------------------
+// ALU benchmarks
+//-------------------------------------------------------------------------
+
+#define ALU_BENCHMARK(name, expression)                 \
+    static void BM_ALU_##name(benchmark::State& state)  \
+    {                                                   \
+        RegistersBank bank = {};                        \
+        ALU alu(&bank);                                 \
+        bank.bc.value = 0x1234;                         \
+        for(auto _ : state)                             \
+        {                                               \
+            benchmark::DoNotOptimize(expression);       \
+            benchmark::ClobberMemory();                 \
+        }                                               \
+        state.SetItemsProcessed(state.iterations());    \
+    }                                                   \
+    BENCHMARK(BM_ALU_##name)
+
+ALU_BENCHMARK(inc8, alu.inc8(&bank.bc, true));
+ALU_BENCHMARK(dec8, alu.dec8(&bank.bc, true));
+ALU_BENCHMARK(add16, alu.add16(&bank.hl, &bank.bc));
+ALU_BENCHMARK(add8_reg, alu.add8(&bank.af, true, &bank.bc, true));
+ALU_BENCHMARK(add8_value, alu.add8(&bank.af, true, (char)0x17));
+ALU_BENCHMARK(adc8_reg, alu.add8(&bank.af, true, &bank.bc, true, true));
+ALU_BENCHMARK(sub8_reg, alu.sub8(&bank.af, true, &bank.bc, true));
+ALU_BENCHMARK(sub8_value, alu.sub8(&bank.af, true, (char)0x17));
+ALU_BENCHMARK(sbc8_reg, alu.sub8(&bank.af, true, &bank.bc, true, true));
+ALU_BENCHMARK(and8_reg, alu.and8(&bank.af, true, &bank.bc, true));
+ALU_BENCHMARK(and8_value, alu.and8(&bank.af, true, (char)0x17));
+ALU_BENCHMARK(or8_reg, alu.or8(&bank.af, true, &bank.bc, true));
+ALU_BENCHMARK(or8_value, alu.or8(&bank.af, true, (char)0x17));
+ALU_BENCHMARK(xor8_reg, alu.xor8(&bank.af, true, &bank.bc, true));
+ALU_BENCHMARK(xor8_value, alu.xor8(&bank.af, true, (char)0x17));
+ALU_BENCHMARK(cp8_reg, alu.cp8(&bank.af, true, &bank.bc, true));
+ALU_BENCHMARK(cp8_value, alu.cp8(&bank.af, true, (char)0x17));
+
+//-------------------------------------------------------------------------
+// CPU::execute benchmarks on opcode mixes
+//-------------------------------------------------------------------------
+
+static void runMix(benchmark::State& state, const std::vector<uint8_t>& block)
+{
+    CPU cpu(RAM_SIZE);
+    load(cpu, buildMix(block));
+    cpu.mainBank.hl.value = 0x8000;
+    cpu.mainBank.de.value = 0x8100;
+    cpu.mainBank.bc.value = 0x8200;
+    cpu.iX.value = 0x8300;
+    cpu.iY.value = 0x8400;
+    cpu.sp.value = 0xF000;
+
+    uint64_t instructions = 0;
+    for(auto _ : state)
+    {
+        cpu.execute();
+        instructions++;
+    }
+    setMIPS(state, instructions);
+}
+
+static void BM_CPU_execute_NOP(benchmark::State& state)
+{
+    runMix(state, {0x00});
+}
+BENCHMARK(BM_CPU_execute_NOP);
+
+static void BM_CPU_execute_LoadMix(benchmark::State& state)
+{
+    // LD A,B / LD C,A / LD D,E / LD A,(HL) / LD (DE),A / LD B,n / LD HL,nn
+    runMix(state, {0x78, 0x4F, 0x53, 0x7E, 0x12, 0x06, 0x11, 0x21, 0x00, 0x80});
+}
+BENCHMARK(BM_CPU_execute_LoadMix);
+
+static void BM_CPU_execute_ALUMix(benchmark::State& state)
+{
+    // ADD A,B / SUB C / AND D / OR E / XOR H / CP L / INC A / DEC B / ADD A,n / CP n
+    runMix(state, {0x80, 0x91, 0xA2, 0xB3, 0xAC, 0xBD, 0x3C, 0x05, 0xC6, 0x03, 0xFE, 0x10});
+}
+BENCHMARK(BM_CPU_execute_ALUMix);
+
+static void BM_CPU_execute_16bitMix(benchmark::State& state)
+{
+    // INC BC / DEC DE / ADD HL,BC / INC HL / ADD HL,DE / DEC HL
+    runMix(state, {0x03, 0x1B, 0x09, 0x23, 0x19, 0x2B});
+}
+BENCHMARK(BM_CPU_execute_16bitMix);
+
+static void BM_CPU_execute_BitMix(benchmark::State& state)
+{
+    // RLC B / RR C / BIT 0,A / SET 0,B / SRL A / RES 0,(HL)
+    runMix(state, {0xCB, 0x00, 0xCB, 0x19, 0xCB, 0x47, 0xCB, 0xC0, 0xCB, 0x3F, 0xCB, 0x86});
+}
+BENCHMARK(BM_CPU_execute_BitMix);
+
+static void BM_CPU_execute_IndexMix(benchmark::State& state)
+{
+    // LD A, (IX+1) / ADD A, (IY+2) / INC IX / LD (IX+3), A / SET 0, (IY+4) / DEC IX
+    runMix(state, {0xDD, 0x7E, 0x01, 0xFD, 0x86, 0x02, 0xDD, 0x23, 0xDD, 0x77, 0x03, 0xFD, 0xCB, 0x04, 0xC6,
+                   0xDD, 0x2B});
+}
+BENCHMARK(BM_CPU_execute_IndexMix);
+
+static void BM_CPU_execute_StackMix(benchmark::State& state)
+{
+    // PUSH BC / PUSH DE / POP HL / POP BC / PUSH AF / POP AF
+    runMix(state, {0xC5, 0xD5, 0xE1, 0xC1, 0xF5, 0xF1});
+}
+BENCHMARK(BM_CPU_execute_StackMix);
+
+static void BM_CPU_execute_BranchMix(benchmark::State& state)
+{
+    // Chain of JP nn to the next instruction
+    std::vector<uint8_t> program;
+    for(uint16_t address = 3; program.size() < 1024; address += 3)
+        program.insert(program.end(), {0xC3, (uint8_t)address, (uint8_t)(address >> 8)});
+    program.insert(program.end(), {0xC3, 0x00, 0x00});
+
+    CPU cpu(RAM_SIZE);
+    load(cpu, program);
+
+    uint64_t instructions = 0;
+    for(auto _ : state)
+    {
+        cpu.execute();
+        instructions++;
+    }
+    setMIPS(state, instructions);
+}
+BENCHMARK(BM_CPU_execute_BranchMix);
+
+//-------------------------------------------------------------------------
+// Whole program benchmarks
+//-------------------------------------------------------------------------
+
+template<class T>
+static void runSieve(benchmark::State& state)
+{
+    uint64_t instructions = 0;
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        T cpu(RAM_SIZE);
+        load(cpu, SIEVE_PROGRAM);
+        state.ResumeTiming();
+
+        instructions += runUntil(cpu, SIEVE_END);
+
+        state.PauseTiming();
+        int primes = 0;
+        for(uint16_t i = 2; i < SIEVE_SIZE; i++)
+            primes += cpu.memory->peek(SIEVE_FLAGS + i);
+        if(primes != 1028)
+            state.SkipWithError("sieve: wrong number of primes");
+        state.ResumeTiming();
+    }
+    setMIPS(state, instructions);
+}
+
+static void BM_Program_Sieve(benchmark::State& state)
+{
+    runSieve<CPU>(state);
+}
+BENCHMARK(BM_Program_Sieve)->Unit(benchmark::kMillisecond);
+
+// Same program on the CPU with the memory size fixed at compile time
+static void BM_Program_Sieve_Fixed(benchmark::State& state)
+{
+    runSieve<FixedCPU<>>(state);
+}
+BENCHMARK(BM_Program_Sieve_Fixed)->Unit(benchmark::kMillisecond);
+
+// Same program with the memory accessed through the virtual methods of Bus
+static void BM_Program_Sieve_Virtual(benchmark::State& state)
+{
+    runSieve<VirtualCPU>(state);
+}
+BENCHMARK(BM_Program_Sieve_Virtual)->Unit(benchmark::kMillisecond);
+
+static void BM_Program_CRC16(benchmark::State& state)
+{
+    const uint16_t start = 0x4000;
+    const uint16_t end = 0x4400;
+
+    std::vector<uint8_t> data(end - start);
+    for(size_t i = 0; i < data.size(); i++)
+        data[i] = (uint8_t)(i * 31 + 7);
+
+    auto program = buildCRCProgram(start, end);
+    uint16_t halt = program.size();
+
+    uint64_t instructions = 0;
+    for(auto _ : state)
+    {
+        state.PauseTiming();
+        CPU cpu(RAM_SIZE);
+        load(cpu, program);
+        load(cpu, data, start);
+        state.ResumeTiming();
+
+        instructions += runUntil(cpu, halt);
+
+        state.PauseTiming();
+        if(cpu.gethl() != crc16(data))
+            state.SkipWithError("crc16: wrong checksum");
+        state.ResumeTiming();
+    }
+    setMIPS(state, instructions);
+}
+BENCHMARK(BM_Program_CRC16)->Unit(benchmark::kMillisecond);
+
+static void BM_Program_LDIR(benchmark::State& state)
+{
+    // LD HL, 4000h / LD DE, 8000h / LD BC, 4000h / LDIR / JP 0000h
+    const std::vector<uint8_t> program = {0x21, 0x00, 0x40, 0x11, 0x00, 0x80, 0x01, 0x00, 0x40,
+                                          0xED, 0xB0, 0xC3, 0x00, 0x00};
+    const uint64_t cycles = 21 * 0x4000;
+    const bool bulk = state.range(0) != 0;
+
+    CPU cpu(RAM_SIZE);
+    load(cpu, program);
+
+    uint64_t instructions = 0;
+    for(auto _ : state)
+    {
+        if(bulk)
+        {
+            instructions += cpu.run(cycles);
+        }
+        else
+        {
+            uint64_t target = cpu.clockCycles + cycles;
+            while(cpu.clockCycles < target)
+            {
+                cpu.execute();
+                instructions++;
+            }
+        }
+    }
+    setMIPS(state, instructions);
+}
+BENCHMARK(BM_Program_LDIR)->ArgName("run")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+static void BM_Program_IdleLoop(benchmark::State& state)
+{
+    // 0000: LD A, (9000h) / AND 01h / JP Z, 0000h (waits for a device)
+    // 0008: LD B, 00h / NOP / DJNZ 000Ah / JP 0000h (delay)
+    const std::vector<uint8_t> program = {0x3A, 0x00, 0x90, 0xE6, 0x01, 0xCA, 0x00, 0x00, 0x06, 0x00,
+                                          0x00, 0x10, 0xFD, 0xC3, 0x00, 0x00};
+
+    CPU cpu(RAM_SIZE);
+    load(cpu, program);
+    cpu.skipIdleLoops = state.range(0) != 0;
+
+    // One simulated second at 3.5 MHz, the device flag toggles every 20 ms
+    uint64_t instructions = 0;
+    for(auto _ : state)
+    {
+        for(int frame = 0; frame < 50; frame++)
+        {
+            cpu.memory->poke(0x9000, frame & 1);
+            instructions += cpu.run(70000);
+        }
+    }
+    setMIPS(state, instructions);
+}
+BENCHMARK(BM_Program_IdleLoop)->ArgName("skip")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+static void BM_Program_Fusion(benchmark::State& state)
+{
+    // 0000: LD HL, 4000h / LD DE, 5000h / LD B, 00h
+    // 0008: LD A, (HL) / INC HL / CP 07h / JR Z, 0010h / LD (DE), A / INC DE
+    // 0010: PUSH BC / PUSH HL / POP HL / POP BC / DEC B / JP NZ, 0008h / JP 0000h
+    const std::vector<uint8_t> program = {0x21, 0x00, 0x40, 0x11, 0x00, 0x50, 0x06, 0x00, 0x7E, 0x23,
+                                          0xFE, 0x07, 0x28, 0x02, 0x12, 0x13, 0xC5, 0xE5, 0xE1, 0xC1,
+                                          0x05, 0xC2, 0x08, 0x00, 0xC3, 0x00, 0x00};
+
+    CPU cpu(RAM_SIZE);
+    load(cpu, program);
+    cpu.sp.value = 0xF000;
+    for(uint16_t i = 0; i < 0x100; i++)
+        cpu.memory->poke(0x4000 + i, i % 13);
+
+    // Pairs chosen from the profile of the program itself
+    Fusion fusion(&cpu);
+    fusion.profile(100000);
+    fusion.configure((unsigned)state.range(0));
+
+    uint64_t instructions = 0;
+    for(auto _ : state)
+        instructions += fusion.run(1000000);
+    setMIPS(state, instructions);
+}
+BENCHMARK(BM_Program_Fusion)->ArgName("pairs")->Arg(0)->Arg(2)->Arg(6)->Unit(benchmark::kMillisecond);
+
+static uint64_t nativeMultiply(void* context, RegistersBank* bank, RAM* memory)
+{
+    uint8_t count = bank->hl.bytes.H;
+    bank->hl.value = count * bank->de.bytes.L;
+    bank->de.bytes.H = 0;
+    bank->bc.bytes.H = 0;
+
+    // 25 cycles per iteration of the guest loop
+    return (count == 0 ? 256 : count) * 25;
+}
+
+static void BM_Program_Traps(benchmark::State& state)
+{
+    // 0000: LD SP, F000h / LD H, FFh / LD E, 0Dh / CALL 0100h / JP 0003h
+    // 0100: LD B, H / LD HL, 0000h / LD D, 0 / ADD HL, DE / DEC B / JP NZ, 0106h / RET
+    const std::vector<uint8_t> program = {0x31, 0x00, 0xF0, 0x26, 0xFF, 0x1E, 0x0D, 0xCD, 0x00, 0x01, 0xC3, 0x03, 0x00};
+    const std::vector<uint8_t> multiply = {0x44, 0x21, 0x00, 0x00, 0x16, 0x00, 0x19, 0x05, 0xC2, 0x06, 0x01, 0xC9};
+
+    CPU cpu(RAM_SIZE);
+    load(cpu, program);
+    load(cpu, multiply, 0x0100);
+
+    Traps traps(&cpu);
+    if(state.range(0) != 0)
+        traps.add(0x0100, &nativeMultiply, nullptr, 31);
+
+    // Simulated cycles per second (the native routine counts as one instruction)
+    uint64_t cycles = 0;
+    for(auto _ : state)
+    {
+        traps.run(1000000);
+        cycles += 1000000;
+    }
+    state.counters["MHz"] = benchmark::Counter(cycles / 1e6, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Program_Traps)->ArgName("native")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+static void BM_Program_Debugger(benchmark::State& state)
+{
+    // 0000: LD HL, 4000h / LD DE, 5000h / LD B, 00h
+    // 0008: LD A, (HL) / INC HL / CP 07h / JR Z, 0010h / LD (DE), A / INC DE
+    // 0010: PUSH BC / PUSH HL / POP HL / POP BC / DEC B / JP NZ, 0008h / JP 0000h
+    const std::vector<uint8_t> program = {0x21, 0x00, 0x40, 0x11, 0x00, 0x50, 0x06, 0x00, 0x7E, 0x23,
+                                          0xFE, 0x07, 0x28, 0x02, 0x12, 0x13, 0xC5, 0xE5, 0xE1, 0xC1,
+                                          0x05, 0xC2, 0x08, 0x00, 0xC3, 0x00, 0x00};
+
+    CPU cpu(RAM_SIZE);
+    load(cpu, program);
+    cpu.sp.value = 0xF000;
+
+    // Breakpoints outside the program (never hit)
+    Debugger debugger(&cpu);
+    for(int64_t i = 0; i < state.range(0); i++)
+        debugger.addBreakpoint(0x8000 + i * 7);
+
+    uint64_t instructions = 0;
+    for(auto _ : state)
+        instructions += debugger.run(1000000);
+    setMIPS(state, instructions);
+}
+BENCHMARK(BM_Program_Debugger)->ArgName("breakpoints")->Arg(0)->Arg(100)->Unit(benchmark::kMillisecond);
+
+// Many instances run in short slices in turn (the registers of every CPU are reloaded for each slice)
+static void BM_Program_Instances(benchmark::State& state)
+{
+    auto program = buildMix({0x80, 0x91, 0xA2, 0xB3, 0xAC, 0xBD, 0x3C, 0x05, 0xC6, 0x03, 0xFE, 0x10});
+
+    std::vector<std::unique_ptr<CPU>> cpus;
+    for(int64_t index = 0; index < state.range(0); index++)
+    {
+        cpus.emplace_back(new CPU(RAM_SIZE));
+        load(*cpus.back(), program);
+        cpus.back()->mainBank.af.value = index;
+    }
+
+    uint64_t instructions = 0;
+    for(auto _ : state)
+    {
+        for(auto& cpu : cpus)
+            instructions += cpu->run(100);
+    }
+    setMIPS(state, instructions);
+}
+BENCHMARK(BM_Program_Instances)->ArgName("cpus")->Arg(16)->Arg(1024);
+
+//-------------------------------------------------------------------------
+// Farm benchmarks
+//-------------------------------------------------------------------------
+
+static void BM_Farm_Sieve(benchmark::State& state)
+{
+    const size_t count = 64;
+    Farm farm(SIEVE_PROGRAM.data(), SIEVE_PROGRAM.size(), 0, (unsigned)state.range(0));
+
+    std::vector<FarmJob> jobs(count);
+    std::vector<FarmResult> results(count);
+    for(auto& job : jobs)
+        job.cycles = 200000;
+
+    uint64_t instructions = 0;
+    for(auto _ : state)
+    {
+        farm.run(jobs.data(), results.data(), count);
+        for(auto& result : results)
+            instructions += result.instructions;
+    }
+    setMIPS(state, instructions);
+}
+BENCHMARK(BM_Farm_Sieve)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+//-------------------------------------------------------------------------
+// Lockstep benchmarks
+//-------------------------------------------------------------------------
+
+// Instances with the same code and different registers (MIPS counts every lane)
+template<unsigned Lanes>
+static void BM_Lockstep_ALUMix(benchmark::State& state)
+{
+    auto program = buildMix({0x80, 0x91, 0xA2, 0xB3, 0xAC, 0xBD, 0x3C, 0x05, 0xC6, 0x03, 0xFE, 0x10});
+
+    std::vector<std::unique_ptr<CPU>> lanes;
+    CPU* cpus[Lanes];
+    for(unsigned lane = 0; lane < Lanes; lane++)
+    {
+        lanes.emplace_back(new CPU(RAM_SIZE));
+        load(*lanes[lane], program);
+        lanes[lane]->mainBank.af.value = lane * 0x1111;
+        lanes[lane]->mainBank.bc.value = lane * 0x0707;
+        cpus[lane] = lanes[lane].get();
+    }
+
+    Lockstep<Lanes> lockstep(cpus);
+    uint64_t instructions = 0;
+    for(auto _ : state)
+        instructions += lockstep.run(10000) * lockstep.getGroupedLanes();
+    setMIPS(state, instructions);
+}
+BENCHMARK_TEMPLATE(BM_Lockstep_ALUMix, 8);
+BENCHMARK_TEMPLATE(BM_Lockstep_ALUMix, 16);
+
+//-------------------------------------------------------------------------
+// Scheduler benchmarks
+//-------------------------------------------------------------------------
+
+// ALU mix with a number of periodic devices and one event every 1000 cycles in total
+static void BM_Scheduler_Devices(benchmark::State& state)
+{
+    CPU cpu(RAM_SIZE);
+    load(cpu, buildMix({0x80, 0x91, 0xA2, 0xB3, 0xAC, 0xBD, 0x3C, 0x05, 0xC6, 0x03, 0xFE, 0x10}));
+
+    uint64_t calls = 0;
+    Scheduler scheduler(&cpu, state.range(0));
+    for(int64_t device = 0; device < state.range(0); device++)
+    {
+        auto callback = [](void* context, uint64_t) { (*static_cast<uint64_t*>(context))++; };
+        scheduler.schedule(1000 * (device + 1), callback, &calls, 1000 * state.range(0));
+    }
+
+    uint64_t instructions = 0;
+    for(auto _ : state)
+        instructions += scheduler.run(100000);
+
+    setMIPS(state, instructions);
+    state.counters["events"] = benchmark::Counter(calls, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Scheduler_Devices)->RangeMultiplier(4)->Range(1, 256);
+
+//-------------------------------------------------------------------------
+// Speedup over a baseline build
+//-------------------------------------------------------------------------
+
+namespace
+{
+
+/**
+ * @brief Read the MIPS of every benchmark from JSON results of Google Benchmark
+ *
+ * The file has one key per line ("name" before the counters of a run).
+ *
+ * @param path JSON file written with --benchmark_out
+ * @return MIPS by benchmark name
+ */
+std::map<std::string, double> loadBaseline(const std::string& path)
+{
+    std::map<std::string, double> mips;
+    std::ifstream file(path);
+    std::string line, name;
+
+    while(std::getline(file, line))
+    {
+        auto key = line.find('"');
+        if(key == std::string::npos)
+            continue;
+
+        if(line.compare(key, 8, "\"name\": ") == 0)
+        {
+            auto start = line.find('"', key + 7) + 1;
+            name = line.substr(start, line.rfind('"') - start);
+        }
+        else if(line.compare(key, 8, "\"MIPS\": ") == 0)
+            mips[name] = std::strtod(line.c_str() + key + 8, nullptr);
+    }
+
+    return mips;
+}
+
+/**
+ * @brief Display reporter adding a speedup counter (MIPS over the baseline MIPS)
+ */
+class SpeedupReporter : public benchmark::BenchmarkReporter
+{
+public:
+    SpeedupReporter(benchmark::BenchmarkReporter* display, const std::map<std::string, double>& baseline)
+        : display(display), baseline(baseline)
+    {
+    }
+
+    bool ReportContext(const Context& context) override
+    {
+        display->SetOutputStream(&GetOutputStream());
+        display->SetErrorStream(&GetErrorStream());
+        return display->ReportContext(context);
+    }
+
+    void ReportRuns(const std::vector<Run>& reports) override
+    {
+        std::vector<Run> runs = reports;
+        for(auto& run : runs)
+        {
+            auto mips = run.counters.find("MIPS");
+            auto base = baseline.find(run.benchmark_name());
+            if(mips != run.counters.end() && base != baseline.end() && base->second > 0)
+                run.counters["speedup"] = benchmark::Counter(mips->second.value / base->second);
+        }
+
+        display->ReportRuns(runs);
+    }
+
+    void Finalize() override { display->Finalize(); }
+
+protected:
+    std::unique_ptr<benchmark::BenchmarkReporter> display;
+    std::map<std::string, double> baseline;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // --emuzeta80_baseline=<file> is removed before Google Benchmark parses the arguments
+    const char* prefix = "--emuzeta80_baseline=";
+    std::string baselinePath;
+    int count = 0;
+    for(int i = 0; i < argc; i++)
+    {
+        if(std::strncmp(argv[i], prefix, std::strlen(prefix)) == 0)
+            baselinePath = argv[i] + std::strlen(prefix);
+        else
+            argv[count++] = argv[i];
+    }
+    argc = count;
+
+    benchmark::Initialize(&argc, argv);
+    if(benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    if(baselinePath.empty())
+    {
+        benchmark::RunSpecifiedBenchmarks();
+    }
+    else
+    {
+        auto baseline = loadBaseline(baselinePath);
+        if(baseline.empty())
+        {
+            std::fprintf(stderr, "no MIPS results in %s\n", baselinePath.c_str());
+            return 1;
+        }
+
+        benchmark::AddCustomContext("emuzeta80_baseline", baselinePath);
+        SpeedupReporter reporter(benchmark::CreateDefaultDisplayReporter(), baseline);
+        benchmark::RunSpecifiedBenchmarks(&reporter);
+    }
+
+    benchmark::Shutdown();
+    return 0;
+}
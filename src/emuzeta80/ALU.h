@@ -23,6 +23,8 @@
  *
  */
 
+#pragma once
+
 //-------------------------------------------------------------------------
 // Includes
 //-------------------------------------------------------------------------
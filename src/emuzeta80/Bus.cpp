@@ -0,0 +1,129 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Bus.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Memory bus with virtual accessors
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include "Bus.h"
+
+//-------------------------------------------------------------------------
+// Class implementation
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Bus class constructor
+ *
+ * @param size The size of the RAM behind the bus in bytes
+ */
+Bus::Bus(uint64_t size) : ram(size)
+{
+}
+
+Bus::~Bus()
+{
+}
+
+/**
+ * @brief Read a byte from the bus
+ *
+ * @param position The memory position to read
+ * @return The byte value at the position
+ */
+uint8_t Bus::peek(uint64_t position)
+{
+    return ram.peek(position);
+}
+
+/**
+ * @brief Write a byte to the bus
+ *
+ * @param position The memory position to write
+ * @param value The byte value to be written
+ */
+void Bus::poke(uint64_t position, uint8_t value)
+{
+    ram.poke(position, value);
+}
+
+/**
+ * @brief Write a block of bytes to the bus (byte by byte with poke)
+ */
+void Bus::load(uint64_t position, const uint8_t* data, uint64_t length)
+{
+    BusBase<Bus>::load(position, data, length);
+}
+
+/**
+ * @brief Read a block of bytes from the bus (byte by byte with peek)
+ */
+void Bus::save(uint64_t position, uint8_t* data, uint64_t length)
+{
+    BusBase<Bus>::save(position, data, length);
+}
+
+/**
+ * @brief Move a block of bytes (byte by byte with peek and poke)
+ *
+ * The blocks may overlap (the result is the same as copying the source
+ * block into a temporary buffer first).
+ */
+void Bus::copy(uint64_t target, uint64_t source, uint64_t length)
+{
+    BusBase<Bus>::copy(target, source, length);
+}
+
+/**
+ * @brief Set a block of bytes to a value (byte by byte with poke)
+ */
+void Bus::fill(uint64_t position, uint8_t value, uint64_t length)
+{
+    BusBase<Bus>::fill(position, value, length);
+}
+
+/**
+ * @brief Check if a block must be written byte by byte (true by default)
+ *
+ * @return true if the block instructions must run one iteration at a time
+ */
+bool Bus::isProtected(uint64_t position, uint64_t length)
+{
+    return BusBase<Bus>::isProtected(position, length);
+}
+
+/**
+ * @brief Check if the reads have no side effects (false by default)
+ *
+ * @return true if the CPU can skip the idle loops that poll the bus
+ */
+bool Bus::hasPureReads()
+{
+    return BusBase<Bus>::hasPureReads();
+}
+
+} // namespace emuzeta80
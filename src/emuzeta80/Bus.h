@@ -0,0 +1,143 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Bus.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Memory buses with custom read and write logic for BasicCPU
+ *
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <cstdint>
+
+#include "RAM.h"
+
+//-------------------------------------------------------------------------
+// Class definition
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Base of the memory buses resolved at compile time
+ *
+ * BasicCPU<Memory> calls peek, fetch, poke, load, save, copy, fill,
+ * isProtected and hasPureReads of its memory and constructs it from the size given to the
+ * CPU (fetch reads the opcodes and operands, peek the data). A bus derived
+ * from BusBase<Derived> only defines peek and poke: fetch and the block
+ * operations call them and every call is inlined.
+ * isProtected returns true, so LDIR, LDDR... run one iteration at a time
+ * and ROM protection, mirroring or watch hooks see every access in order;
+ * a bus can override it for the ranges that can be copied in bulk.
+ * hasPureReads returns false, so idle loops are not skipped: a bus whose
+ * reads have no side effects can override it.
+ * BasicCPU<Derived> is instantiated by the host (CPUImpl.h).
+ */
+template<class Derived>
+class BusBase
+{
+public:
+    uint8_t fetch(uint64_t position)
+    {
+        return self().peek(position);
+    }
+
+    void load(uint64_t position, const uint8_t* data, uint64_t length)
+    {
+        for(uint64_t i = 0; i < length; i++)
+            self().poke(position + i, data[i]);
+    }
+
+    void save(uint64_t position, uint8_t* data, uint64_t length)
+    {
+        for(uint64_t i = 0; i < length; i++)
+            data[i] = self().peek(position + i);
+    }
+
+    void copy(uint64_t target, uint64_t source, uint64_t length)
+    {
+        // Same result as copying the source block into a temporary buffer first
+        if(target <= source)
+        {
+            for(uint64_t i = 0; i < length; i++)
+                self().poke(target + i, self().peek(source + i));
+        }
+        else
+        {
+            for(uint64_t i = length; i > 0; i--)
+                self().poke(target + i - 1, self().peek(source + i - 1));
+        }
+    }
+
+    void fill(uint64_t position, uint8_t value, uint64_t length)
+    {
+        for(uint64_t i = 0; i < length; i++)
+            self().poke(position + i, value);
+    }
+
+    bool isProtected(uint64_t position, uint64_t length)
+    {
+        (void) position;
+        (void) length;
+        return true;
+    }
+
+    bool hasPureReads()
+    {
+        return false;
+    }
+
+private:
+    Derived& self() { return *static_cast<Derived*>(this); }
+};
+
+/**
+ * @brief Memory bus with virtual accessors, for hosts that choose the memory behavior at run time
+ *
+ * The default implementation is a RAM of the given size. Derived classes
+ * override peek and poke (and optionally the block operations, which call
+ * peek and poke by default). Every access of a VirtualCPU is a virtual
+ * call, so it is slower than CPU or a compile-time bus.
+ */
+class Bus : public BusBase<Bus>
+{
+public:
+    Bus(uint64_t size = 0x10000);
+    virtual ~Bus();
+
+    virtual uint8_t peek(uint64_t position);
+    virtual void poke(uint64_t position, uint8_t value);
+    virtual void load(uint64_t position, const uint8_t* data, uint64_t length);
+    virtual void save(uint64_t position, uint8_t* data, uint64_t length);
+    virtual void copy(uint64_t target, uint64_t source, uint64_t length);
+    virtual void fill(uint64_t position, uint8_t value, uint64_t length);
+    virtual bool isProtected(uint64_t position, uint64_t length);
+    virtual bool hasPureReads();
+
+protected:
+    RAM ram;
+};
+
+} // namespace emuzeta80
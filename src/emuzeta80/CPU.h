@@ -30,10 +30,13 @@
 //-------------------------------------------------------------------------
 
 #include <cstdint>
+#include <type_traits>
 
 #include "ALU.h"
+#include "Bus.h"
 #include "RAM.h"
 #include "RegistersBank.h"
+#include "Snapshot.h"
 
 //-------------------------------------------------------------------------
 // Class definition
@@ -42,45 +45,193 @@
 namespace emuzeta80
 {
 
-class CPU
+/**
+ * @brief Register that replaces HL in an instruction (selected by the DD and FD prefixes)
+ */
+enum IndexRegister
+{
+    INDEX_HL,
+    INDEX_IX,
+    INDEX_IY
+};
+
+#ifdef EMUZETA80_TIMING
+/**
+ * @brief Type of machine cycle reported to the contention hook
+ */
+enum BusCycle
 {
+    BUS_FETCH,  //< Opcode fetch (M1), 4 T-states
+    BUS_READ,   //< Memory read, 3 T-states
+    BUS_WRITE,  //< Memory write, 3 T-states
+    BUS_INPUT,  //< I/O read, 4 T-states
+    BUS_OUTPUT  //< I/O write, 4 T-states
+};
+#endif
+
+/**
+ * @brief Z80 CPU with the memory class as a parameter
+ *
+ * Memory is RAM (size set at run time, CPU), FixedRAM (size set at
+ * compile time, FixedCPU) or Bus (virtual accessors, VirtualCPU), all of
+ * them instantiated in CPU.cpp. Any class with the interface of RAM can be
+ * used (see BusBase) by instantiating BasicCPU for it with CPUImpl.h.
+ *
+ * The ALU and the memory created by the size constructor are stored in
+ * the CPU object itself, so a CPU is a single block (placement new in an
+ * arena constructs one without any other allocation, apart from the
+ * content of RAM) and it cannot be copied.
+ *
+ * The object is aligned to a cache line and starts with the state used by
+ * every instruction (memory, main registers, clock cycles, ALU, interrupt
+ * flags), so running a CPU touches one line besides the memory; the
+ * alternate registers, the hooks and the debugger state follow. Objects
+ * with a CPU member need -faligned-new (or C++17) to be aligned by new.
+ */
+template<class Memory>
+class alignas(64) BasicCPU
+{
+    friend class Fusion;   //< Fused handlers of instruction pairs
+    friend class Traps;    //< Native replacements of guest routines
+    friend class Debugger; //< Breakpoints and watchpoints
+
 public:
-    CPU(uint64_t ramSize);
+    BasicCPU(uint64_t ramSize = 0x10000);
+    BasicCPU(Memory* memory);
+    ~BasicCPU();
+
+    BasicCPU(const BasicCPU&) = delete;
+    BasicCPU& operator=(const BasicCPU&) = delete;
+
+    static void* operator new(size_t size);
+    static void* operator new(size_t size, void* place) { return place; }
+    static void operator delete(void* pointer);
 
     uint16_t execute();
+    uint64_t run(uint64_t cycles);
+    void save(Snapshot& snapshot);
+    void restore(const Snapshot& snapshot);
     uint16_t getpc();
     uint16_t getsp();
     uint16_t getaf(bool alt = false);
     uint16_t getbc(bool alt = false);
     uint16_t getde(bool alt = false);
     uint16_t gethl(bool alt = false);
+    uint8_t getr();
+    void setr(uint8_t value);
     uint64_t getClockCycles();
     void incpc();
     void setpc(uint16_t value);
     uint8_t read(uint16_t address = -1);
     void write(uint8_t value, uint16_t address = -1);
+    void interrupt(uint8_t data = 0xFF);
 
 protected:
+    uint8_t fetchByte(uint16_t address);
+    uint8_t readByte(uint16_t address);
+    uint8_t readOperand();
+    void writeByte(uint16_t address, uint8_t value);
+#ifdef EMUZETA80_TIMING
+    void busCycle(BusCycle cycle, uint16_t address, uint16_t length);
+#endif
+    void internalCycles(uint16_t length);
+    uint16_t read16(Register* reg16);
+    uint16_t readOperand16();
+    bool condition(uint8_t cc);
     uint16_t jp(bool condition);
+    uint16_t jr(bool condition);
     uint16_t call(bool condition);
     uint16_t ret(bool condition);
     uint16_t rst(uint16_t address);
     uint16_t ld8mem(Register* reg16, bool high);
     uint16_t inc8mem(uint16_t address);
     uint16_t dec8mem(uint16_t address);
+    template<int Index> uint16_t executeIndexed(uint8_t opcode);
+    template<int Index> Register& indexRegister();
+    template<int Index> uint16_t indexAddress(uint16_t cycles = 8, uint16_t internal = 5);
+    template<bool Indexed> uint16_t executeCB(uint16_t address);
+    template<int Operation, int Index, bool Indexed> uint16_t cb(uint16_t address);
+    uint8_t in(uint16_t port);
+    void out(uint16_t port, uint8_t value);
+    uint16_t acceptInterrupt();
+    uint16_t executeED();
+    uint16_t repeatLimit(uint32_t count);
+    uint16_t block(bool (BasicCPU::*step)(int), int delta, bool repeat, uint32_t count);
+    uint16_t blockTransfer(int delta, bool repeat);
+    bool bulkTransfer(int delta, uint16_t length);
+    bool ldStep(int delta);
+    bool cpStep(int delta);
+    bool inStep(int delta);
+    bool outStep(int delta);
+    void skipIdleLoop(uint16_t branch);
+    uint64_t runDebug(uint64_t target);
 
 public:
-    RAM* memory;
-    ALU* alu;
+    // Hot state: the first cache line of the object (checked in the constructor)
+    Memory* memory;
     RegistersBank mainBank;
-    RegistersBank alternateBank;
     Register pc; //< Program Counter
     Register sp; //< Stack Pointer
     Register iX; //< Index X;
     Register iY; //< Index Y;
-    uint8_t i;   //< Interruption Vector
-    uint8_t r;   //< Memory Refresh
     uint64_t clockCycles = 0;
+    ALU alu;
+    uint8_t i;   //< Interruption Vector
+
+    bool iff1 = false;              //< Interrupts enabled
+    bool iff2 = false;              //< Copy of iff1 during NMI
+    uint8_t im = 0;                 //< Interrupt mode (0, 1, 2)
+    bool interruptPending = false;  //< Maskable interrupt requested
+    uint8_t interruptData = 0xFF;   //< Byte on the data bus during the interrupt acknowledge
+
+protected:
+    uint8_t r;                     //< Memory Refresh when set, R adds the M1 cycles since (see getr)
+    uint8_t refreshes = 0;         //< M1 cycles of the prefixes, minus instructionCount when R was set
+    bool interruptDelay = false;   //< EI was the last instruction
+    uint64_t instructionCount = 0; //< Executed instructions (every iteration of a block instruction counts)
+
+public:
+    // Cold state
+    RegistersBank alternateBank;
+
+    // I/O ports (IN reads 0xFF and OUT is ignored if not set)
+    uint8_t (*input)(void* context, uint16_t port) = nullptr;
+    void (*output)(void* context, uint16_t port, uint8_t value) = nullptr;
+    void* ioContext = nullptr;
+
+    bool skipIdleLoops = false; //< Fast-forward loops without side effects in run()
+
+#ifdef EMUZETA80_TIMING
+    // Machine cycles (returns the wait states inserted at T-state tstate of the instruction)
+    uint8_t (*contention)(void* context, BusCycle cycle, uint16_t address, uint16_t tstate) = nullptr;
+    void* busContext = nullptr;
+#endif
+
+protected:
+    uint64_t deadline = 0;       //< Clock cycles limit of the current run (block instructions)
+    bool ownsMemory = false;     //< memory was constructed in ownMemory
+
+    // Debugger state (run() checks it only when breakpoints is set)
+    const uint64_t* breakpoints = nullptr; //< Bit per address: stop before the instruction (but the first)
+    bool watching = false;                 //< One iteration of the block instructions per step
+    bool stopping = false;                 //< Stop after the current instruction
+#ifdef EMUZETA80_TIMING
+    uint16_t tstate = 0;         //< T-states elapsed in the current instruction (machine and internal cycles)
+#endif
+
+    // Memory created by the size constructor (uninitialized for an external memory)
+    typename std::aligned_storage<sizeof(Memory), alignof(Memory)>::type ownMemory;
 };
 
+typedef BasicCPU<RAM> CPU; //< Memory size set at run time
+
+template<size_t Size = 0x10000>
+using FixedCPU = BasicCPU<FixedRAM<Size>>; //< Memory size set at compile time
+
+typedef BasicCPU<Bus> VirtualCPU; //< Memory accessed through the virtual methods of Bus
+
+extern template class BasicCPU<RAM>;
+extern template class BasicCPU<FixedRAM<0x10000>>;
+extern template class BasicCPU<Bus>;
+
 } // namespace emuzeta80
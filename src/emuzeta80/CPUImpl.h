@@ -0,0 +1,4372 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file CPUImpl.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Implementation of the BasicCPU template for the Z80 emulator
+ *
+ * CPU.cpp instantiates it for RAM, FixedRAM<0x10000> and Bus. Hosts with
+ * their own memory bus include this file in one source file and
+ * instantiate BasicCPU for it (with the same EMUZETA80_TIMING setting as
+ * the library they link).
+ *
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include "CPU.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+//-------------------------------------------------------------------------
+// Class implementation
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Construct a new CPU instance
+ *
+ * Create a RAM memory inside the CPU object (destroyed with the CPU)
+ * Initialize values of all registers to 0
+ */
+template<class Memory>
+BasicCPU<Memory>::BasicCPU(uint64_t ramSize) : BasicCPU(reinterpret_cast<Memory*>(&ownMemory))
+{
+    // Constructed here: GCC drops the stores made to the object before its constructor starts
+    new(&ownMemory) Memory(ramSize);
+    ownsMemory = true;
+}
+
+/**
+ * @brief Construct a new CPU instance on an existing memory
+ *
+ * The memory (a Bus subclass for VirtualCPU) is not copied and must outlive
+ * the CPU.
+ *
+ * @param memory memory accessed by the CPU
+ */
+template<class Memory>
+BasicCPU<Memory>::BasicCPU(Memory* memory) : alu(&mainBank)
+{
+    // BasicCPU is not standard-layout, but GCC lays the members out in declaration order
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+    static_assert(offsetof(BasicCPU, memory) == 0 && offsetof(BasicCPU, instructionCount) + sizeof(instructionCount) <= 64,
+                  "the hot state of the CPU must fit in its first cache line");
+#pragma GCC diagnostic pop
+
+    this->memory = memory;
+
+    mainBank = RegistersBank();
+    alternateBank = RegistersBank();
+    pc.value = 0;
+    sp.value = 0;
+    iX.value = 0;
+    iY.value = 0;
+    i = 0;
+    r = 0;
+}
+
+/**
+ * @brief Destroy the CPU and the memory created by the size constructor
+ */
+template<class Memory>
+BasicCPU<Memory>::~BasicCPU()
+{
+    if(ownsMemory)
+        memory->~Memory();
+}
+
+/**
+ * @brief Allocate a CPU aligned to a cache line
+ *
+ * The global operator new of C++11 only aligns to 16 bytes.
+ */
+template<class Memory>
+void* BasicCPU<Memory>::operator new(size_t size)
+{
+    void* pointer = nullptr;
+    if(posix_memalign(&pointer, alignof(BasicCPU), size) != 0)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+/**
+ * @brief Free a CPU allocated by operator new
+ */
+template<class Memory>
+void BasicCPU<Memory>::operator delete(void* pointer)
+{
+    free(pointer);
+}
+
+/**
+ * @brief Get current value of PC register
+ *
+ * @return value of PC register
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::getpc()
+{
+    return pc.value;
+}
+
+/**
+ * @brief Get current value of SP register
+ *
+ * @return value of SP register
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::getsp()
+{
+    return pc.value;
+}
+
+/**
+ * @brief Get current value of AF register
+ *
+ * @alt if true return AF' (alternate bank) else AF (main bank)
+ * @return value of AF register
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::getaf(bool alt)
+{
+    return alt ? alternateBank.af.value : mainBank.af.value;
+}
+
+/**
+ * @brief Get current value of BC register
+ *
+ * @alt if true return BC' (alternate bank) else BC (main bank)
+ * @return value of BC register
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::getbc(bool alt)
+{
+    return alt ? alternateBank.bc.value : mainBank.bc.value;
+}
+
+/**
+ * @brief Get current value of DE register
+ *
+ * @alt if true return DE' (alternate bank) else DE (main bank)
+ * @return value of DE register
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::getde(bool alt)
+{
+    return alt ? alternateBank.de.value : mainBank.de.value;
+}
+
+/**
+ * @brief Get current value of HL register
+ *
+ * @alt if true return HL' (alternate bank) else HL (main bank)
+ * @return value of HL register
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::gethl(bool alt)
+{
+    return alt ? alternateBank.hl.value : mainBank.hl.value;
+}
+
+/**
+ * @brief Get current value of R register
+ *
+ * R is not updated by every M1 cycle: the instructions are taken from the
+ * instruction counter and only the prefixes are counted apart. Bit 7 only
+ * changes with LD R, A.
+ *
+ * @return value of R register
+ */
+template<class Memory>
+uint8_t BasicCPU<Memory>::getr()
+{
+    return (r & 0x80) | ((r + (uint8_t)instructionCount + refreshes) & 0x7F);
+}
+
+/**
+ * @brief Set value of R register
+ *
+ * @param value Value to set the R register
+ */
+template<class Memory>
+void BasicCPU<Memory>::setr(uint8_t value)
+{
+    r = value;
+    refreshes = -(uint8_t)instructionCount;
+}
+
+/**
+ * @brief Get total of consumed clock cycles
+ *
+ * @return number of consumed clock cycles
+ */
+template<class Memory>
+uint64_t BasicCPU<Memory>::getClockCycles()
+{
+    return clockCycles;
+}
+
+/**
+ * @brief Increase value of PC register by one
+ *
+ */
+template<class Memory>
+void BasicCPU<Memory>::incpc()
+{
+    pc.value++;
+}
+
+/**
+ * @brief Set value of Program Counter (PC) register to a specific value
+ *
+ * @param value Value to set the PC register
+ */
+template<class Memory>
+void BasicCPU<Memory>::setpc(uint16_t value)
+{
+    pc.value = value;
+}
+
+/**
+ * @brief Read value from a position of memory
+ *
+ * @param address memory address to read value (if not set value is written in memory pointed by PC register)
+ * @return value retrieved from memory address
+ */
+template<class Memory>
+uint8_t BasicCPU<Memory>::read(uint16_t address)
+{
+    if(address < 0)
+        address = pc.value;
+
+    return memory->peek(address);
+}
+
+/**
+ * @brief Write value into a position of memory
+ *
+ * @param value 8-bit value to be written in memory
+ * @param address memory address to write value (if not set value is written in memory pointed by PC register)
+ */
+template<class Memory>
+void BasicCPU<Memory>::write(uint8_t value, uint16_t address)
+{
+    if(address < 0)
+        address = pc.value;
+
+    memory->poke(address, value);
+}
+
+/**
+ * @brief Read the opcode of an instruction or prefix (M1 cycle)
+ *
+ * @param address memory address of the opcode
+ * @return opcode
+ */
+template<class Memory>
+inline uint8_t BasicCPU<Memory>::fetchByte(uint16_t address)
+{
+#ifdef EMUZETA80_TIMING
+    busCycle(BUS_FETCH, address, 4);
+#endif
+    return memory->fetch(address);
+}
+
+/**
+ * @brief Read a byte from memory (memory read cycle)
+ *
+ * @param address memory address
+ * @return value retrieved from memory
+ */
+template<class Memory>
+inline uint8_t BasicCPU<Memory>::readByte(uint16_t address)
+{
+#ifdef EMUZETA80_TIMING
+    busCycle(BUS_READ, address, 3);
+#endif
+    return memory->peek(address);
+}
+
+/**
+ * @brief Read the instruction byte at PC and increment PC (memory read cycle)
+ *
+ * Operands are instruction bytes: they are read like the opcodes, so they
+ * do not trigger the read watchpoints of the data.
+ *
+ * @return value retrieved from memory
+ */
+template<class Memory>
+inline uint8_t BasicCPU<Memory>::readOperand()
+{
+#ifdef EMUZETA80_TIMING
+    busCycle(BUS_READ, pc.value, 3);
+#endif
+    return memory->fetch(pc.value++);
+}
+
+/**
+ * @brief Write a byte into memory (memory write cycle)
+ *
+ * @param address memory address
+ * @param value value to be written
+ */
+template<class Memory>
+inline void BasicCPU<Memory>::writeByte(uint16_t address, uint8_t value)
+{
+#ifdef EMUZETA80_TIMING
+    busCycle(BUS_WRITE, address, 3);
+#endif
+    memory->poke(address, value);
+}
+
+/**
+ * @brief Advance the T-state of the instruction without bus activity
+ *
+ * Internal cycles (address calculation, 16-bit arithmetic, extended M1
+ * cycles) delay the following machine cycles. Only counted with
+ * EMUZETA80_TIMING, the clock cycles already include them.
+ *
+ * @param length T-states
+ */
+template<class Memory>
+inline void BasicCPU<Memory>::internalCycles(uint16_t length)
+{
+#ifdef EMUZETA80_TIMING
+    tstate += length;
+#endif
+}
+
+#ifdef EMUZETA80_TIMING
+/**
+ * @brief Report a machine cycle to the contention hook
+ *
+ * The wait states returned by the hook are added to the clock cycles and
+ * delay the following machine cycles of the instruction.
+ *
+ * @param cycle type of machine cycle
+ * @param address memory address or I/O port on the bus
+ * @param length T-states of the machine cycle without wait states
+ */
+template<class Memory>
+void BasicCPU<Memory>::busCycle(BusCycle cycle, uint16_t address, uint16_t length)
+{
+    uint16_t waits = contention != nullptr ? contention(busContext, cycle, address, tstate) : 0;
+    tstate += length + waits;
+    clockCycles += waits;
+}
+#endif
+
+/**
+ * @brief Read a little-endian 16-bit value from memory
+ *
+ * The low byte is read first from the address in the register, which is
+ * increased by two (operands read through PC, values popped through SP).
+ *
+ * @param reg16 register with the memory address (pc, sp)
+ * @return value retrieved from memory
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::read16(Register* reg16)
+{
+    uint8_t low = readByte(reg16->value++);
+    uint8_t high = readByte(reg16->value++);
+
+    return low | (high << 8);
+}
+
+/**
+ * @brief Read a 16-bit operand at PC and increment PC
+ *
+ * @return 16-bit value (low byte first)
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::readOperand16()
+{
+    uint8_t low = readOperand();
+    uint8_t high = readOperand();
+
+    return low | (high << 8);
+}
+
+/**
+ * @brief Request a maskable interrupt
+ *
+ * The interrupt is accepted before the next instruction once interrupts are
+ * enabled (EI). The request stays pending until it is accepted.
+ *
+ * @param data byte on the data bus: instruction in mode 0 (RST), low byte of the vector in mode 2
+ */
+template<class Memory>
+void BasicCPU<Memory>::interrupt(uint8_t data)
+{
+    interruptPending = true;
+    interruptData = data;
+}
+
+/**
+ * @brief Accept the pending maskable interrupt
+ *
+ * @return number of cycles of the interrupt acknowledge
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::acceptInterrupt()
+{
+    interruptPending = false;
+    iff1 = false;
+    iff2 = false;
+
+    // Acknowledge cycle (M1 with two wait states, no memory read)
+    internalCycles(7);
+    writeByte(--sp.value, pc.bytes.H);
+    writeByte(--sp.value, pc.bytes.L);
+
+    if(im == 2)
+    {
+        Register vector;
+        vector.value = (i << 8) | (interruptData & 0xFE);
+        pc.value = read16(&vector);
+        return 19;
+    }
+
+    // Mode 0 only supports RST instructions on the data bus
+    pc.value = im == 1 ? 0x0038 : interruptData & 0x38;
+    return 13;
+}
+
+/**
+ * @brief Read a value from an I/O port
+ *
+ * @param port port address (16 bits)
+ * @return value read from the port (0xFF if there is no input handler)
+ */
+template<class Memory>
+uint8_t BasicCPU<Memory>::in(uint16_t port)
+{
+#ifdef EMUZETA80_TIMING
+    busCycle(BUS_INPUT, port, 4);
+#endif
+    return input != nullptr ? input(ioContext, port) : 0xFF;
+}
+
+/**
+ * @brief Write a value to an I/O port
+ *
+ * @param port port address (16 bits)
+ * @param value value to write
+ */
+template<class Memory>
+void BasicCPU<Memory>::out(uint16_t port, uint8_t value)
+{
+#ifdef EMUZETA80_TIMING
+    busCycle(BUS_OUTPUT, port, 4);
+#endif
+    if(output != nullptr)
+        output(ioContext, port, value);
+}
+
+/**
+ * @brief Copy the registers of the CPU into a snapshot
+ *
+ * @param snapshot target snapshot
+ */
+template<class Memory>
+void BasicCPU<Memory>::save(Snapshot& snapshot)
+{
+    snapshot.mainBank = mainBank;
+    snapshot.alternateBank = alternateBank;
+    snapshot.pc = pc;
+    snapshot.sp = sp;
+    snapshot.iX = iX;
+    snapshot.iY = iY;
+    snapshot.i = i;
+    snapshot.r = getr();
+    snapshot.iff1 = iff1;
+    snapshot.iff2 = iff2;
+    snapshot.im = im;
+    snapshot.interruptDelay = interruptDelay;
+    snapshot.clockCycles = clockCycles;
+}
+
+/**
+ * @brief Set the registers of the CPU from a snapshot
+ *
+ * @param snapshot source snapshot
+ */
+template<class Memory>
+void BasicCPU<Memory>::restore(const Snapshot& snapshot)
+{
+    mainBank = snapshot.mainBank;
+    alternateBank = snapshot.alternateBank;
+    pc = snapshot.pc;
+    sp = snapshot.sp;
+    iX = snapshot.iX;
+    iY = snapshot.iY;
+    i = snapshot.i;
+    setr(snapshot.r);
+    iff1 = snapshot.iff1;
+    iff2 = snapshot.iff2;
+    im = snapshot.im;
+    interruptDelay = snapshot.interruptDelay;
+    clockCycles = snapshot.clockCycles;
+}
+
+namespace detail
+{
+
+/**
+ * @brief Conditions NZ, Z, NC, C, PO, PE, P and M for every value of F
+ */
+struct Conditions
+{
+    bool taken[8][256];
+
+    Conditions()
+    {
+        // Bits 1-2 of the condition select the flag and bit 0 its value
+        const uint8_t flags[4] = {FLAG_Z, FLAG_C, FLAG_P, FLAG_S};
+
+        for(int cc = 0; cc < 8; cc++)
+        {
+            for(int f = 0; f < 256; f++)
+                taken[cc][f] = ((f & flags[cc >> 1]) != 0) == ((cc & 1) != 0);
+        }
+    }
+};
+
+extern const Conditions conditions; //< Defined in CPU.cpp
+
+} // namespace detail
+
+/**
+ * @brief Evaluate the condition of a conditional instruction
+ *
+ * @param cc condition (bits 3-5 of JP, CALL and RET, bits 3-4 of JR)
+ * @return true if the condition is met by the current flags
+ */
+template<class Memory>
+bool BasicCPU<Memory>::condition(uint8_t cc)
+{
+    return detail::conditions.taken[cc][mainBank.af.bytes.L];
+}
+
+/**
+ * @brief Conditional jump based on the specified condition
+ *
+ * @param condition The boolean condition that determines whether to perform the jump
+ * @return number of cycles of the operation
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::jp(bool condition)
+{
+    // The address is read even if the jump is not taken
+    auto value = readOperand16();
+    if(condition)
+        pc.value = value;
+
+    return 10;
+}
+
+/**
+ * @brief Conditional relative jump based on the specified condition
+ *
+ * @param condition The boolean condition that determines whether to perform the jump
+ * @return number of cycles of the operation
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::jr(bool condition)
+{
+    // The displacement is read even if the jump is not taken
+    auto offset = (int8_t)readOperand();
+    if(condition)
+    {
+        internalCycles(5);
+        pc.value += offset;
+        return 12;
+    }
+
+    return 7;
+}
+
+/**
+ * @brief Conditional subroutine call base on the specified condiction
+ *
+ * @param condition The boolean condition that determines whether to perform the call operation
+ * @return number of cycles of the operation
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::call(bool condition)
+{
+    // The address is read even if the call is not taken
+    auto value = readOperand16();
+    if(condition)
+    {
+        internalCycles(1);
+        writeByte(--sp.value, pc.bytes.H);
+        writeByte(--sp.value, pc.bytes.L);
+        pc.value = value;
+
+        return 17;
+    }
+
+    return 10;
+}
+
+/**
+ * @brief Conditional return based on the specified condition
+ *
+ * @param condition The boolean condition that determines whether to perform the ret operation
+ * @return number of cycles of the operation
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::ret(bool condition)
+{
+    // The condition is evaluated in a 5 T-states M1 cycle
+    internalCycles(1);
+    if(condition)
+    {
+        pc.value = read16(&sp);
+        return 11;
+    }
+
+    return 5;
+}
+
+/**
+ * @brief Subroutine call to the specified address
+ *
+ * @param address target address
+ * @return number of cycles of the operation
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::rst(uint16_t address)
+{
+    internalCycles(1);
+    writeByte(--sp.value, pc.bytes.H);
+    writeByte(--sp.value, pc.bytes.L);
+    pc.value = address;
+
+    return 11;
+}
+
+/**
+ * @brief Increases value of a byte in memory by one
+ *
+ * @param address memory address with value to be increased
+ * @return number of cycles of the operation
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::inc8mem(uint16_t address)
+{
+    uint8_t value = readByte(address);
+    uint8_t updatedValue = value + 1;
+    internalCycles(1);
+    writeByte(address, updatedValue);
+
+    mainBank.setFlag(Flag::FLAG_N, false);
+    mainBank.setFlag(Flag::FLAG_P, value == 0x7F);
+    mainBank.setFlag(Flag::FLAG_H, value == 0x0F);
+    mainBank.setFlag(Flag::FLAG_Z, updatedValue == 0);
+    mainBank.setFlag(Flag::FLAG_S, updatedValue == 0x80);
+
+    return 11;
+}
+
+/**
+ * @brief Decreases value of a byte in memory by one
+ *
+ * @param address memory address with value to be decreased
+ * @return uint16_t number of cycles of the operation
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::dec8mem(uint16_t address)
+{
+    uint8_t value = readByte(address);
+    uint8_t updatedValue = value - 1;
+    internalCycles(1);
+    writeByte(address, updatedValue);
+
+    mainBank.setFlag(Flag::FLAG_N, true);
+    mainBank.setFlag(Flag::FLAG_P, value == 0x80); // -128 = 0x80 in 2a complement
+    mainBank.setFlag(Flag::FLAG_H, updatedValue == 0x0F);
+    mainBank.setFlag(Flag::FLAG_Z, updatedValue == 0);
+    mainBank.setFlag(Flag::FLAG_S, updatedValue == 0x7F);
+
+    return 11;
+}
+
+/**
+ * @brief Load contents of a memory cell to a 16-bit register
+ *
+ * @param reg16 target register (bc, de, hl, af)
+ * @param high flag to specify if select the higher or lower byte of the target register
+ * @return uint16_t number of cycles of the operation
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::ld8mem(Register* reg16, bool high)
+{
+    if(high)
+        reg16->bytes.H = readOperand();
+    else
+        reg16->bytes.L = readOperand();
+
+    return 7;
+}
+
+/**
+ * @brief Execute instruction pointed by PC register
+ *
+ * This method processes the following steps.
+ *  - Get byte pointed by PC register
+ *  - Increase value of PC register by 1
+ *  - Execute instruction according to the value of retrieved byte
+ * 		- some instructions requires more than one byte
+ * 		- in these cases, the bytes are retrieved and the value of PC register is increased according to the number of bytes
+ * 	- Update flags if required
+ *  - Update total number of cycle clocks
+ *
+ * @return uint16_t
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::execute()
+{
+#ifdef EMUZETA80_TIMING
+    tstate = 0;
+#endif
+    instructionCount++;
+
+    if(interruptPending && iff1 && !interruptDelay)
+    {
+        clockCycles += acceptInterrupt();
+        return 0;
+    }
+    interruptDelay = false;
+
+    auto opcode = fetchByte(pc.value++);
+    return executeIndexed<INDEX_HL>(opcode);
+}
+
+/**
+ * @brief Get the register used as HL by the current instruction
+ *
+ * @return HL, IX or IY
+ */
+template<class Memory>
+template<int Index>
+Register& BasicCPU<Memory>::indexRegister()
+{
+    return Index == INDEX_IX ? iX : Index == INDEX_IY ? iY : mainBank.hl;
+}
+
+/**
+ * @brief Get the address of the (HL) operand of the current instruction
+ *
+ * With the DD and FD prefixes the operand is (IX+d) or (IY+d) and the
+ * displacement d is read from the byte pointed by PC.
+ *
+ * @param cycles additional clock cycles of the displacement
+ * @param internal T-states without bus activity after the displacement (address calculation)
+ * @return address of the operand
+ */
+template<class Memory>
+template<int Index>
+uint16_t BasicCPU<Memory>::indexAddress(uint16_t cycles, uint16_t internal)
+{
+    if(Index == INDEX_HL)
+        return mainBank.hl.value;
+
+    auto displacement = (int8_t)readOperand();
+    internalCycles(internal);
+    clockCycles += cycles;
+    return indexRegister<Index>().value + displacement;
+}
+
+/**
+ * @brief Execute an instruction with HL replaced by an index register
+ *
+ * The same handlers execute the unprefixed instructions (INDEX_HL) and the
+ * DD (INDEX_IX) and FD (INDEX_IY) prefixed ones. Instructions that do not
+ * use HL ignore the prefix, EX DE, HL and EXX always use HL and the
+ * instructions with a (HL) operand keep H and L as the other operand.
+ *
+ * @param opcode byte of the instruction after the prefixes
+ * @return uint16_t
+ */
+template<class Memory>
+template<int Index>
+uint16_t BasicCPU<Memory>::executeIndexed(uint8_t opcode)
+{
+    Register& hl = indexRegister<Index>();
+
+    switch(opcode)
+    {
+    case 0x0:
+    {
+        // 0: NOP
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x01:
+    {
+        // 1: LD BC, **
+        // Load content of memory to the BC register
+        // Flags affected: None
+
+        mainBank.bc.bytes.L = readOperand();
+        mainBank.bc.bytes.H = readOperand();
+        clockCycles += 10;
+        break;
+    }
+
+    case 0x02:
+    {
+        // 2: LD (BC), A
+        // Store A register into the position of memory located by BC register
+        // Flags affected: None
+
+        writeByte(mainBank.bc.value, mainBank.af.bytes.H);
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x03:
+    {
+        // 3: INC BC
+        // Increase BC register by 1
+        // Flags affected: None
+
+        mainBank.bc.value += 1;
+        internalCycles(2);
+        clockCycles += 6;
+        break;
+    }
+
+    case 0x04:
+    {
+        // 4: INC B
+        // Increases value of B by one
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.inc8(&(mainBank.bc), true);
+        break;
+    }
+
+    case 0x05:
+    {
+        // 5: DEC B
+        // Decrements value of B by one
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.dec8(&(mainBank.bc), true);
+        break;
+    }
+
+    case 0x06:
+    {
+        // 6: LD B, *
+        // Loads contents of memory (*) to B
+        // Flags affected: None
+
+        clockCycles += ld8mem(&(mainBank.bc), true);
+        break;
+    }
+
+    case 0x07:
+    {
+        // 7: RLCA
+        // The contents of a are rotated left one bit position
+        // The value of the bit 7 are copied to FLAG_C and bit 0
+        // Flags affected: C, N, H
+
+        auto bit7 = (mainBank.af.bytes.H & 0x80) == 1;
+        mainBank.af.bytes.H = mainBank.af.bytes.H << 1;
+        mainBank.af.bytes.H = bit7 ? mainBank.af.bytes.H | 0x80 : mainBank.af.bytes.H & 0xFE;
+
+        mainBank.setFlag(Flag::FLAG_C, bit7);
+        mainBank.setFlag(Flag::FLAG_N, 0);
+        mainBank.setFlag(Flag::FLAG_H, 0);
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x08:
+    {
+        // 8: EX AF, AF'
+        // Exchanges the contents of AF and AF'
+
+        uint16_t af = mainBank.af.value;
+        mainBank.af.value = alternateBank.af.value;
+        alternateBank.af.value = mainBank.af.value;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x09:
+    {
+        // 9: ADD HL, BC
+        // Adds the value of BC to HL
+        // Flags affected: C, N, H
+
+        internalCycles(7);
+        clockCycles += alu.add16(&(hl), &(mainBank.bc));
+        break;
+    }
+
+    case 0x0A:
+    {
+        // 10: LD A, (BC)
+        // Loads the content of memory pointed by BC to A
+        // Flags affected: None
+
+        mainBank.af.bytes.H = readByte(mainBank.bc.value);
+
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x0B:
+    {
+        // 11: DEC BC
+        // Decreases the value of BC by 1
+        // Flags affected: None
+
+        mainBank.bc.value -= 1;
+
+        internalCycles(2);
+        clockCycles += 6;
+        break;
+    }
+
+    case 0x0C:
+    {
+        // 12: INC C
+        // Increase the value of C by 1
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.inc8(&(mainBank.bc), false);
+        break;
+    }
+
+    case 0x0D:
+    {
+        // 13: DEC C
+        // Decrease the value of C by 1
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.dec8(&(mainBank.bc), false);
+        break;
+    }
+
+    case 0x0E:
+    {
+        // 14: LD C, *
+        // Loads contents of memory (*) to B
+        // Flags affected: None
+
+        clockCycles += ld8mem(&(mainBank.bc), false);
+        break;
+    }
+
+    case 0x0F:
+    {
+        // 15: RRCA
+        // The contents of a are rotated right one bit position
+        // The value of the bit 0 are copied to FLAG_C and bit 7
+        // Flags affected: C, N, H
+
+        auto bit0 = (mainBank.af.bytes.H & 0x01) == 1;
+        mainBank.af.bytes.H = mainBank.af.bytes.H >> 1;
+        mainBank.af.bytes.H = bit0 ? mainBank.af.bytes.H | 0x80 : mainBank.af.bytes.H & 0x7F;
+
+        mainBank.setFlag(Flag::FLAG_C, bit0);
+        mainBank.setFlag(Flag::FLAG_N, 0);
+        mainBank.setFlag(Flag::FLAG_H, 0);
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x10:
+    {
+        // 16: DJNZ *
+        // The B register is decremented by one
+        // If the result is not zero, PC is incremented by *
+        // Flags affected: None
+
+        internalCycles(1);
+        clockCycles += jr(--mainBank.bc.bytes.H != 0) + 1;
+        break;
+    }
+
+    case 0x11:
+    {
+        // 17: LD DE, **
+        // Load content of memory to the DE register
+        // Flags affected: None
+
+        mainBank.de.bytes.L = readOperand();
+        mainBank.de.bytes.H = readOperand();
+        clockCycles += 10;
+        break;
+    }
+
+    case 0x12:
+    {
+        // 18: LD (DE), A
+        // Store A register into the position of memory located by DE
+        // Flags affected: None
+
+        writeByte(mainBank.de.value, mainBank.af.bytes.H);
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x13:
+    {
+        // 19: INC DE
+        // Increase DE register by 1
+        // Flags affected: None
+
+        mainBank.de.value += 1;
+        internalCycles(2);
+        clockCycles += 6;
+        break;
+    }
+
+    case 0x14:
+    {
+        // 20: INC D
+        // Increases value of D by one
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.inc8(&(mainBank.de), true);
+        break;
+    }
+
+    case 0x15:
+    {
+        // 21: DEC D
+        // Decrements value of D by one
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.dec8(&(mainBank.de), true);
+        break;
+    }
+
+    case 0x16:
+    {
+        // 22: LD D, *
+        // Loads contents of memory (*) to D
+        // Flags affected: None
+
+        clockCycles += ld8mem(&(mainBank.de), true);
+        break;
+    }
+
+    case 0x17:
+    {
+        // 23: RLA
+        // The contents of a are rotated left one bit position
+        // The value of the bit 7 is copied to FLAG_C
+        // The previous value of FLAG_C is copied to bit 0
+        // Flags affected: C, N, H
+
+        auto bit7 = (mainBank.af.bytes.H & 0x80) == 1;
+        auto flagC = mainBank.getFlag(Flag::FLAG_C) == 1;
+        mainBank.af.bytes.H = mainBank.af.bytes.H << 1;
+        mainBank.af.bytes.H = flagC ? mainBank.af.bytes.H | 0x01 : mainBank.af.bytes.H & 0xFE;
+
+        mainBank.setFlag(Flag::FLAG_C, bit7);
+        mainBank.setFlag(Flag::FLAG_N, 0);
+        mainBank.setFlag(Flag::FLAG_H, 0);
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x18:
+    {
+        // 24: JR *
+        // PC is increase by * (signed value)
+        // Flags affected: None
+
+        clockCycles += jr(true);
+        break;
+    }
+
+    case 0x19:
+    {
+        // 25: ADD HL, DE
+        // Adds the value of DE to HL
+        // Flags affected: C, N, H
+
+        internalCycles(7);
+        clockCycles += alu.add16(&(hl), &(mainBank.de));
+        break;
+    }
+
+    case 0x1A:
+    {
+        // 26: LD A, (DE)
+        // Loads the content of memory pointed by DE to A
+        // Flags affected: None
+
+        mainBank.af.bytes.H = readByte(mainBank.de.value);
+
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x1B:
+    {
+        // 27: DEC DE
+        // Decreases the value of DE by 1
+        // Flags affected: None
+
+        mainBank.de.value -= 1;
+
+        internalCycles(2);
+        clockCycles += 6;
+        break;
+    }
+
+    case 0x1C:
+    {
+        // 28: INC E
+        // Increase the value of E by 1
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.inc8(&(mainBank.de), false);
+        break;
+    }
+
+    case 0x1D:
+    {
+        // 29: DEC E
+        // Decrease the value of E by 1
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.dec8(&(mainBank.de), false);
+        break;
+    }
+
+    case 0x1E:
+    {
+        // 30: LD E, *
+        // Loads contents of memory (*) to E
+        // Flags affected: None
+
+        clockCycles += ld8mem(&(mainBank.de), false);
+        break;
+    }
+
+    case 0x1F:
+    {
+        // 31: RRA
+        // The contents of a are rotated right one bit position
+        // The value of the bit 0 are copied to FLAG_C
+        // The previous value of FLAG_C is copied to bit 7
+        // Flags affected: C, N, H
+
+        auto bit0 = (mainBank.af.bytes.H & 0x01) == 1;
+        auto flag_c = mainBank.getFlag(Flag::FLAG_C) == 1;
+        mainBank.af.bytes.H = mainBank.af.bytes.H >> 1;
+        mainBank.af.bytes.H = flag_c ? mainBank.af.bytes.H | 0x80 : mainBank.af.bytes.H & 0x7F;
+
+        mainBank.setFlag(Flag::FLAG_C, bit0);
+        mainBank.setFlag(Flag::FLAG_N, 0);
+        mainBank.setFlag(Flag::FLAG_H, 0);
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x20: // 32: JR NZ, *
+    case 0x28: // 40: JR Z, *
+    case 0x30: // 48: JR NC, *
+    case 0x38: // 56: JR C, *
+    {
+        // PC is increased by * (signed value) if the condition in bits 3-4 of the opcode is true
+        // Flags affected: None
+
+        clockCycles += jr(condition((opcode >> 3) & 3));
+        break;
+    }
+
+    case 0x21:
+    {
+        // 33: LD HL, **
+        // Load content of memory to the DE register
+        // Flags affected: None
+
+        hl.bytes.L = readOperand();
+        hl.bytes.H = readOperand();
+        clockCycles += 10;
+        break;
+    }
+
+    case 0x22:
+    {
+        // 34: LD (**), HL
+        // Load content of HL register into memory
+        // Flags affected: None
+
+        auto address = readOperand16();
+        writeByte(address, hl.bytes.L);
+        writeByte(address + 1, hl.bytes.H);
+        clockCycles += 16;
+        break;
+    }
+
+    case 0x23:
+    {
+        // 35: INC HL
+        // Increase HL register by 1
+        // Flags affected: None
+
+        hl.value += 1;
+        internalCycles(2);
+        clockCycles += 6;
+        break;
+    }
+
+    case 0x24:
+    {
+        // 36: INC H
+        // Increases value of D by one
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.inc8(&(hl), true);
+        break;
+    }
+
+    case 0x25:
+    {
+        // 37: DEC H
+        // Decrements value of H by one
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.dec8(&(hl), true);
+        break;
+    }
+
+    case 0x26:
+    {
+        // 38: LD H, *
+        // Loads contents of memory (*) to H
+        // Flags affected: None
+
+        clockCycles += ld8mem(&(hl), true);
+        break;
+    }
+
+    case 0x27:
+    {
+        // 39: DAA
+
+        // TODO
+        // Implements DAA instruction
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x29:
+    {
+        // 41: ADD HL, HL
+        // Adds the value of HL to HL
+        // Flags affected: C, N, H
+
+        internalCycles(7);
+        clockCycles += alu.add16(&(hl), &(hl));
+        break;
+    }
+
+    case 0x2A:
+    {
+        // 42: LD HL, (**)
+        // Loads the content of memory pointed by ** to HL (H<-(**+1), L<-(**))
+        // Flags affected: None
+
+        auto address = readOperand16();
+        hl.bytes.L = readByte(address);
+        hl.bytes.H = readByte(address + 1);
+
+        clockCycles += 16;
+        break;
+    }
+
+    case 0x2B:
+    {
+        // 43: DEC HL
+        // Decreases the value of HL by 1
+        // Flags affected: None
+
+        hl.value -= 1;
+
+        internalCycles(2);
+        clockCycles += 6;
+        break;
+    }
+
+    case 0x2C:
+    {
+        // 44: INC L
+        // Increase the value of L by 1
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.inc8(&(hl), false);
+        break;
+    }
+
+    case 0x2D:
+    {
+        // 45: DEC L
+        // Decrease the value of L by 1
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.dec8(&(hl), false);
+        break;
+    }
+
+    case 0x2E:
+    {
+        // 46: LD L, *
+        // Loads contents of memory (*) to L
+        // Flags affected: None
+
+        clockCycles += ld8mem(&(hl), false);
+        break;
+    }
+
+    case 0x2F:
+    {
+        // 48: CPA
+        // Inverts the value of register A
+        // Flags affected: N, H
+
+        // TODO
+        // Implement CPA instruction
+
+        mainBank.af.bytes.H = (char)~mainBank.af.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x31:
+    {
+        // 50: LD SP, **
+        // Load content of memory to the SP register
+        // Flags affected: None
+
+        sp.bytes.L = readOperand();
+        sp.bytes.H = readOperand();
+
+        clockCycles += 10;
+        break;
+    }
+
+    case 0x32:
+    {
+        // 51: LD (**), A
+        // Load content of A register into memory
+        // Flags affected: None
+
+        auto address = readOperand16();
+        writeByte(address, mainBank.af.bytes.H);
+
+        clockCycles += 13;
+        break;
+    }
+
+    case 0x33:
+    {
+        // 52: INC SP
+        // Increase SP register by 1
+        // Flags affected: None
+
+        sp.value += 1;
+
+        internalCycles(2);
+        clockCycles += 6;
+        break;
+    }
+
+    case 0x34:
+    {
+        // 53: INC (HL)
+        // Increase value of memory pointed by HL register by 1
+        // Flags affected: N, P, H, Z, S
+
+        auto address = indexAddress<Index>();
+        clockCycles += inc8mem(address);
+        break;
+    }
+
+    case 0x35:
+    {
+        // 54: DEC (HL)
+        // Decrease value of memory pointed by HL register by 1
+        // Flags affected: N, P, H, Z, S
+
+        auto address = indexAddress<Index>();
+        clockCycles += dec8mem(address);
+        break;
+    }
+
+    case 0x36:
+    {
+        // 54: LD (HL), *
+        // Load * into position of memory pointed by HL register
+        // Flags affected: None
+
+        auto address = indexAddress<Index>(5, 0);
+        auto value = readOperand();
+        if(Index != INDEX_HL)
+            internalCycles(2);
+        writeByte(address, value);
+
+        clockCycles += 10;
+        break;
+    }
+
+    case 0x37:
+    {
+        // 55: SCF
+        // Sets FLAG_C to true
+        // Flags affected: C, N, H
+
+        mainBank.setFlag(Flag::FLAG_C, true);
+        mainBank.setFlag(Flag::FLAG_H, false);
+        mainBank.setFlag(Flag::FLAG_N, false);
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x39:
+    {
+        // 57: ADD HL, SP
+        // Adds the value of SP to HL
+        // Flags affected: C, N, H
+
+        internalCycles(7);
+        clockCycles += alu.add16(&(hl), &sp);
+        break;
+    }
+
+    case 0x3A:
+    {
+        // 58: LD A, (**)
+        // Loads the content of memory pointed by ** to A
+        // Flags affected: None
+
+        auto address = readOperand16();
+        mainBank.af.bytes.H = readByte(address);
+
+        clockCycles += 13;
+        break;
+    }
+
+    case 0x3B:
+    {
+        // 59: DEC SP
+        // Decreases the value of SP by 1
+        // Flags affected: None
+
+        sp.value -= 1;
+
+        internalCycles(2);
+        clockCycles += 6;
+        break;
+    }
+
+    case 0x3C:
+    {
+        // 60: INC A
+        // Increase the value of A by 1
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.inc8(&(mainBank.af), true);
+        break;
+    }
+
+    case 0x3D:
+    {
+        // 61: DEC
+        // Decrease the value of A by 1
+        // Flags affected: N, P, H, Z, S
+
+        clockCycles += alu.dec8(&(mainBank.af), true);
+        break;
+    }
+
+    case 0x3E:
+    {
+        // 62: LD A, *
+        // Loads contents of memory (*) to A
+        // Flags affected: None
+
+        clockCycles += ld8mem(&(mainBank.af), true);
+        break;
+    }
+
+    case 0x3F:
+    {
+        // 63: CCF
+        // Inverts the value of FLAG_C
+        // Flags affected: C, N, H
+
+        mainBank.setFlag(Flag::FLAG_H, mainBank.getFlag(Flag::FLAG_C));
+        mainBank.setFlag(Flag::FLAG_C, ~mainBank.getFlag(Flag::FLAG_C));
+        mainBank.setFlag(Flag::FLAG_N, false);
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x40:
+    {
+        // 64: LD B, B
+        // Loads B into B
+        // Flags affected: None
+
+        // Nothing to do (B <- B)
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x41:
+    {
+        // 65: LD B, C
+        // Loads C into B
+        // Flags affected: None
+
+        mainBank.bc.bytes.H = mainBank.bc.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x42:
+    {
+        // 66: LD B, D
+        // Loads D into B
+        // Flags affected: None
+
+        mainBank.bc.bytes.H = mainBank.de.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x43:
+    {
+        // 67: LD B, E
+        // Loads E into B
+        // Flags affected: None
+
+        mainBank.bc.bytes.H = mainBank.de.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x44:
+    {
+        // 68: LD B, H
+        // Loads H into B
+        // Flags affected: None
+
+        mainBank.bc.bytes.H = hl.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x45:
+    {
+        // 69: LD B, L
+        // Loads L into B
+        // Flags affected: None
+
+        mainBank.bc.bytes.H = hl.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x46:
+    {
+        // 70: LD B, (HL)
+        // Loads contents of memory pointed by HL into B
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        mainBank.bc.bytes.H = readByte(address);
+
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x47:
+    {
+        // 71: LD B, A
+        // Loads A into B
+        // Flags affected: None
+
+        mainBank.bc.bytes.H = mainBank.af.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x48:
+    {
+        // 72: LD C, B
+        // Loads B into C
+        // Flags affected: None
+
+        mainBank.bc.bytes.L = mainBank.bc.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x49:
+    {
+        // 73: LD C, C
+        // Loads C into C
+        // Flags affected: None
+
+        // Nothing to do (C <- C)
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x4A:
+    {
+        // 74: LD C, D
+        // Loads D into C
+        // Flags affected: None
+
+        mainBank.bc.bytes.L = mainBank.de.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x4B:
+    {
+        // 75: LD C, E
+        // Loads E into C
+        // Flags affected: None
+
+        mainBank.bc.bytes.L = mainBank.de.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x4C:
+    {
+        // 76: LD C, H
+        // Loads H into C
+        // Flags affected: None
+
+        mainBank.bc.bytes.L = hl.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x4D:
+    {
+        // 77: LD C, L
+        // Loads L into C
+        // Flags affected: None
+
+        mainBank.bc.bytes.L = hl.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x4E:
+    {
+        // 78: LD C, (HL)
+        // Loads content of memory pointed by HL into C
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        mainBank.bc.bytes.L = readByte(address);
+
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x4F:
+    {
+        // 79: LD C, A
+        // Loads A into C
+        // Flags affected: None
+
+        mainBank.bc.bytes.L = mainBank.af.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x50:
+    {
+        // 80: LD D, B
+        // Loads B into D
+        // Flags affected: None
+
+        mainBank.de.bytes.H = mainBank.bc.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x51:
+    {
+        // 81: LD D, C
+        // Loads C into D
+        // Flags affected: None
+
+        mainBank.de.bytes.H = mainBank.bc.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x52:
+    {
+        // 82: LD D, D
+        // Loads D into D
+        // Flags affected: None
+
+        // Nothing to do (D <- D)
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x53:
+    {
+        // 83: LD D, E
+        // Loads E into D
+        // Flags affected: None
+
+        mainBank.de.bytes.H = mainBank.de.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x54:
+    {
+        // 84: LD D, H
+        // Loads H into D
+        // Flags affected: None
+
+        mainBank.de.bytes.H = hl.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x55:
+    {
+        // 85: LD D, L
+        // Loads L into D
+        // Flags affected: None
+
+        mainBank.de.bytes.H = hl.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x56:
+    {
+        // 86: LD D, (HL)
+        // Loads contents of memory pointed by HL into D
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        mainBank.de.bytes.H = readByte(address);
+
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x57:
+    {
+        // 87: LD D, A
+        // Loads A into D
+        // Flags affected: None
+
+        mainBank.de.bytes.H = mainBank.af.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x58:
+    {
+        // 88: LD E, B
+        // Loads B into E
+        // Flags affected: None
+
+        mainBank.de.bytes.L = mainBank.bc.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x59:
+    {
+        // 89: LD E, C
+        // Loads C into E
+        // Flags affected: None
+
+        mainBank.de.bytes.L = mainBank.bc.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x5A:
+    {
+        // 90: LD E, D
+        // Loads D into E
+        // Flags affected: None
+
+        mainBank.de.bytes.L = mainBank.de.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x5B:
+    {
+        // 91: LD E, E
+        // Loads E into E
+        // Flags affected: None
+
+        // Nothing to do (E <- E)
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x5C:
+    {
+        // 92: LD E, H
+        // Loads H into E
+        // Flags affected: None
+
+        mainBank.de.bytes.L = hl.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x5D:
+    {
+        // 93: LD E, L
+        // Loads H into E
+        // Flags affected: None
+
+        mainBank.de.bytes.L = hl.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x5E:
+    {
+        // 94: LD E, (HL)
+        // Loads content of memory pointed by HL into C
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        mainBank.de.bytes.L = readByte(address);
+
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x5F:
+    {
+        // 95: LD E, A
+        // Loads A into E
+        // Flags affected: None
+
+        mainBank.de.bytes.L = mainBank.af.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x60:
+    {
+        // 96: LD H, B
+        // Loads B into H
+        // Flags affected: None
+
+        hl.bytes.H = mainBank.bc.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x61:
+    {
+        // 97: LD H, C
+        // Loads C into H
+        // Flags affected: None
+
+        hl.bytes.H = mainBank.bc.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x62:
+    {
+        // 98: LD H, D
+        // Loads D into H
+        // Flags affected: None
+
+        hl.bytes.H = mainBank.de.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x63:
+    {
+        // 99: LD H, E
+        // Loads E into H
+        // Flags affected: None
+
+        hl.bytes.H = mainBank.de.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x64:
+    {
+        // 100: LD H, H
+        // Loads H into H
+        // Flags affected: None
+
+        // Nothing to do (H <- H)
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x65:
+    {
+        // 101: LD H, L
+        // Loads L into H
+        // Flags affected: None
+
+        hl.bytes.H = hl.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x66:
+    {
+        // 102: LD H, (HL)
+        // Loads contents of memory pointed by HL into H
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        mainBank.hl.bytes.H = readByte(address);
+
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x67:
+    {
+        // 103: LD H, A
+        // Loads A into H
+        // Flags affected: None
+
+        hl.bytes.H = mainBank.af.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x68:
+    {
+        // 104: LD L, B
+        // Loads B into L
+        // Flags affected: None
+
+        hl.bytes.L = mainBank.bc.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x69:
+    {
+        // 105: LD L, C
+        // Loads C into L
+        // Flags affected: None
+
+        hl.bytes.L = mainBank.bc.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x6A:
+    {
+        // 106: LD L, D
+        // Loads D into L
+        // Flags affected: None
+
+        hl.bytes.L = mainBank.de.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x6B:
+    {
+        // 107: LD L, E
+        // Loads E into L
+        // Flags affected: None
+
+        hl.bytes.L = mainBank.de.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x6C:
+    {
+        // 108: LD L, H
+        // Loads H into L
+        // Flags affected: None
+
+        hl.bytes.L = hl.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x6D:
+    {
+        // 109: LD L, L
+        // Loads L into L
+        // Flags affected: None
+
+        // Nothing to do (L <- L)
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x6E:
+    {
+        // 110: LD L, (HL)
+        // Loads content of memory pointed by HL into L
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        mainBank.hl.bytes.L = readByte(address);
+
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x6F:
+    {
+        // 111: LD L, A
+        // Loads A into L
+        // Flags affected: None
+
+        hl.bytes.L = mainBank.af.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x70:
+    {
+        // 112: LD (HL), B
+        // Store B register into the position of memory located by HL register
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        writeByte(address, mainBank.bc.bytes.H);
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x71:
+    {
+        // 113: LD (HL), C
+        // Store C register into the position of memory located by HL register
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        writeByte(address, mainBank.bc.bytes.L);
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x72:
+    {
+        // 114: LD (HL), D
+        // Store D register into the position of memory located by HL register
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        writeByte(address, mainBank.de.bytes.H);
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x73:
+    {
+        // 115: LD (HL), E
+        // Store E register into the position of memory located by HL register
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        writeByte(address, mainBank.de.bytes.L);
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x74:
+    {
+        // 116: LD (HL), H
+        // Store H register into the position of memory located by HL register
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        writeByte(address, mainBank.hl.bytes.H);
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x75:
+    {
+        // 117: LD (HL), L
+        // Store L register into the position of memory located by HL register
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        writeByte(address, mainBank.hl.bytes.L);
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x76:
+    {
+        // 118: HALT
+
+        // TODO
+        // Implement suspension of CPU
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x77:
+    {
+        // 119: LD (HL), A
+        // Store A register into the position of memory located by HL register
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        writeByte(address, mainBank.af.bytes.H);
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x78:
+    {
+        // 120: LD A, B
+        // Loads B into A
+        // Flags affected: None
+
+        mainBank.af.bytes.H = mainBank.bc.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x79:
+    {
+        // 121: LD A, C
+        // Loads C into A
+        // Flags affected: None
+
+        mainBank.af.bytes.H = mainBank.bc.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x7A:
+    {
+        // 122: LD A, D
+        // Loads D into A
+        // Flags affected: None
+
+        mainBank.af.bytes.H = mainBank.de.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x7B:
+    {
+        // 123: LD A, E
+        // Loads E into A
+        // Flags affected: None
+
+        mainBank.af.bytes.H = mainBank.de.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x7C:
+    {
+        // 124: LD A, H
+        // Loads H into A
+        // Flags affected: None
+
+        mainBank.af.bytes.H = hl.bytes.H;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x7D:
+    {
+        // 125: LD A, L
+        // Loads L into A
+        // Flags affected: None
+
+        mainBank.af.bytes.H = hl.bytes.L;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x7E:
+    {
+        // 126: LD A, (HL)
+        // Loads the content of memory pointed by HL to A
+        // Flags affected: None
+
+        auto address = indexAddress<Index>();
+        mainBank.af.bytes.H = readByte(address);
+
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x7F:
+    {
+        // 127: LD A, A
+        // Loads A into A
+        // Flags affected: None
+
+        // Nothing to do (A <- A)
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x80:
+    {
+        // 128: ADD A, B
+        // Adds B to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(mainBank.bc), true);
+        break;
+    }
+
+    case 0x81:
+    {
+        // 129: ADD A, C
+        // Adds C to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(mainBank.bc), false);
+        break;
+    }
+
+    case 0x82:
+    {
+        // 130: ADD A, D
+        // Adds D to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(mainBank.de), true);
+        break;
+    }
+
+    case 0x83:
+    {
+        // 131: ADD A, E
+        // Adds E to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(mainBank.de), false);
+        break;
+    }
+
+    case 0x84:
+    {
+        // 132: ADD A, H
+        // Adds H to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(hl), true);
+        break;
+    }
+
+    case 0x85:
+    {
+        // 133: ADD A, L
+        // Adds L to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(hl), false);
+        break;
+    }
+
+    case 0x86:
+    {
+        // 134: ADD A, (HL)
+        // Adds contents of memory pointed by HL to A
+        // Flags affected: C, N, P, H, Z, S
+
+        auto address = indexAddress<Index>();
+        char value = (char)readByte(address);
+        clockCycles += alu.add8(&(mainBank.af), true, value) + 3;
+        break;
+    }
+
+    case 0x87:
+    {
+        // 135: ADD A, A
+        // Adds A to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(mainBank.af), true);
+        break;
+    }
+
+    case 0x88:
+    {
+        // 136: ADC A, B
+        // Adds B and carry flag to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(mainBank.bc), true, true);
+        break;
+    }
+
+    case 0x89:
+    {
+        // 137: ADC A, C
+        // Adds C and carry flag to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(mainBank.bc), false, true);
+        break;
+    }
+
+    case 0x8A:
+    {
+        // 138: ADC A, D
+        // Adds D and carry flag to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(mainBank.de), true, true);
+        break;
+    }
+
+    case 0x8B:
+    {
+        // 139: ADC A, E
+        // Adds E and carry flag to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(mainBank.de), false, true);
+        break;
+    }
+
+    case 0x8C:
+    {
+        // 140: ADC A, H
+        // Adds H and carry flag to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(hl), true, true);
+        break;
+    }
+
+    case 0x8D:
+    {
+        // 141: ADC A, L
+        // Adds L and carry flag to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(hl), false, true);
+        break;
+    }
+
+    case 0x8E:
+    {
+        // 142: ADC A, (HL)
+        // Adds contents of memory pointed by HL and carry flag to A
+        // Flags affected: C, N, P, H, Z, S
+
+        auto address = indexAddress<Index>();
+        char value = (char)readByte(address);
+        clockCycles += alu.add8(&(mainBank.af), true, value, true) + 3;
+        break;
+    }
+
+    case 0x8F:
+    {
+        // 143: ADC A, A
+        // Adds A and carry flag to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.add8(&(mainBank.af), true, &(mainBank.af), true, true);
+        break;
+    }
+
+    case 0x90:
+    {
+        // 144: SUB B
+        // Subtracts B from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(mainBank.bc), true, false);
+        break;
+    }
+
+    case 0x91:
+    {
+        // 145: SUB C
+        // Subtracts C from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(mainBank.bc), false, false);
+        break;
+    }
+
+    case 0x92:
+    {
+        // 146: SUB D
+        // Subtracts C from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(mainBank.de), true, false);
+        break;
+    }
+
+    case 0x93:
+    {
+        // 147: SUB E
+        // Subtracts E from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(mainBank.de), false, false);
+        break;
+    }
+
+    case 0x94:
+    {
+        // 148: SUB H
+        // Subtracts H from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(hl), true, false);
+        break;
+    }
+
+    case 0x95:
+    {
+        // 149: SUB L
+        // Subtracts L from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(hl), false, false);
+        break;
+    }
+
+    case 0x96:
+    {
+        // 150: SUB (HL)
+        // Subtracts contents of memory pointed by HL from A
+        // Flags affected: C, N, P, H, Z, S
+
+        auto address = indexAddress<Index>();
+        char value = (char)readByte(address);
+        clockCycles += alu.sub8(&(mainBank.af), true, value, false) + 3;
+        break;
+    }
+
+    case 0x97:
+    {
+        // 151: SUB A
+        // Subtracts A from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(mainBank.af), true, false);
+        break;
+    }
+
+    case 0x98:
+    {
+        // 152: SBC A, B
+        // Subtracts B and carry flag from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(mainBank.bc), true, true);
+        break;
+    }
+
+    case 0x99:
+    {
+        // 153: SBC A, C
+        // Subtracts C and carry flag from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(mainBank.bc), false, true);
+        break;
+    }
+
+    case 0x9A:
+    {
+        // 154: SBC A, D
+        // Subtracts D and carry flag from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(mainBank.de), true, true);
+        break;
+    }
+
+    case 0x9B:
+    {
+        // 155: SBC A, E
+        // Subtracts E and carry flag from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(mainBank.de), false, true);
+        break;
+    }
+
+    case 0x9C:
+    {
+        // 156: SBC A, H
+        // Subtracts H and carry flag from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(hl), true, true);
+        break;
+    }
+
+    case 0x9D:
+    {
+        // 157: SBC A, L
+        // Subtracts L and carry flag from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(hl), false, true);
+        break;
+    }
+
+    case 0x9E:
+    {
+        // 158: SBC A, (HL)
+        // Subtracts contents of memory pointed by HL and carry flag from A
+        // Flags affected: C, N, P, H, Z, S
+
+        auto address = indexAddress<Index>();
+        char value = (char)readByte(address);
+        clockCycles += alu.sub8(&(mainBank.af), true, value, true) + 3;
+        break;
+    }
+
+    case 0x9F:
+    {
+        // 159: SBC A, A
+        // Subtracts A and carry flag from A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.sub8(&(mainBank.af), true, &(mainBank.af), true, true);
+        break;
+    }
+
+    case 0xA0:
+    {
+        // 160: AND B
+        // AND operation from B to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.and8(&(mainBank.af), true, &(mainBank.bc), true);
+        break;
+    }
+
+    case 0xA1:
+    {
+        // 161: AND C
+        // AND operation from C to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.and8(&(mainBank.af), true, &(mainBank.bc), false);
+        break;
+    }
+
+    case 0xA2:
+    {
+        // 162: AND D
+        // AND operation from D to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.and8(&(mainBank.af), true, &(mainBank.de), true);
+        break;
+    }
+
+    case 0xA3:
+    {
+        // 163: AND E
+        // AND operation from E to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.and8(&(mainBank.af), true, &(mainBank.de), false);
+        break;
+    }
+
+    case 0xA4:
+    {
+        // 164: AND H
+        // AND operation from H to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.and8(&(mainBank.af), true, &(hl), true);
+        break;
+    }
+
+    case 0xA5:
+    {
+        // 165: AND L
+        // AND operation L to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.and8(&(mainBank.af), true, &(hl), false);
+        break;
+    }
+
+    case 0xA6:
+    {
+        // 166: AND (HL)
+        // AND operation from contents of memory pointed by HL to A
+        // Flags affected: C, N, P, H, Z, S
+
+        auto address = indexAddress<Index>();
+        char value = (char)readByte(address);
+        clockCycles += alu.and8(&(mainBank.af), true, value) + 3;
+        break;
+    }
+
+    case 0xA7:
+    {
+        // 167: AND A
+        // AND operation from A to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.and8(&(mainBank.af), true, &(mainBank.af), true);
+        break;
+    }
+
+    case 0xA8:
+    {
+        // 168: XOR B
+        // XOR operation from B to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.xor8(&(mainBank.af), true, &(mainBank.bc), true);
+        break;
+    }
+
+    case 0xA9:
+    {
+        // 169: XOR C
+        // XOR operation from C to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.xor8(&(mainBank.af), true, &(mainBank.bc), false);
+        break;
+    }
+
+    case 0xAA:
+    {
+        // 170: XOR D
+        // XOR operation from D to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.xor8(&(mainBank.af), true, &(mainBank.de), true);
+        break;
+    }
+
+    case 0xAB:
+    {
+        // 171: XOR E
+        // XOR operation from E to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.xor8(&(mainBank.af), true, &(mainBank.de), false);
+        break;
+    }
+
+    case 0xAC:
+    {
+        // 172: XOR H
+        // XOR operation from H to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.xor8(&(mainBank.af), true, &(hl), true);
+        break;
+    }
+
+    case 0xAD:
+    {
+        // 173: XOR L
+        // XOR operation L to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.xor8(&(mainBank.af), true, &(hl), false);
+        break;
+    }
+
+    case 0xAE:
+    {
+        // 174: XOR (HL)
+        // XOR operation from contents of memory pointed by HL to A
+        // Flags affected: C, N, P, H, Z, S
+
+        auto address = indexAddress<Index>();
+        char value = (char)readByte(address);
+        clockCycles += alu.xor8(&(mainBank.af), true, value) + 3;
+        break;
+    }
+
+    case 0xAF:
+    {
+        // 175: XOR A
+        // XOR operation from A to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.xor8(&(mainBank.af), true, &(mainBank.af), true);
+        break;
+    }
+
+    case 0xB0:
+    {
+        // 176: OR B
+        // OR operation from B to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.or8(&(mainBank.af), true, &(mainBank.bc), true);
+        break;
+    }
+
+    case 0xB1:
+    {
+        // 177: OR C
+        // OR operation from C to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.or8(&(mainBank.af), true, &(mainBank.bc), false);
+        break;
+    }
+
+    case 0xB2:
+    {
+        // 178: OR D
+        // OR operation from D to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.or8(&(mainBank.af), true, &(mainBank.de), true);
+        break;
+    }
+
+    case 0xB3:
+    {
+        // 179: OR E
+        // OR operation from E to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.or8(&(mainBank.af), true, &(mainBank.de), false);
+        break;
+    }
+
+    case 0xB4:
+    {
+        // 180: OR H
+        // OR operation from H to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.or8(&(mainBank.af), true, &(hl), true);
+        break;
+    }
+
+    case 0xB5:
+    {
+        // 181: OR L
+        // OR operation from L to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.or8(&(mainBank.af), true, &(hl), false);
+        break;
+    }
+
+    case 0xB6:
+    {
+        // 182: OR (HL)
+        // OR operation from contents of memory pointed by HL to A
+        // Flags affected: C, N, P, H, Z, S
+
+        auto address = indexAddress<Index>();
+        char value = (char)readByte(address);
+        clockCycles += alu.or8(&(mainBank.af), true, value) + 3;
+        break;
+    }
+
+    case 0xB7:
+    {
+        // 183: OR A
+        // OR operation from A to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.or8(&(mainBank.af), true, &(mainBank.af), true);
+        break;
+    }
+
+    case 0xB8:
+    {
+        // 184: CP B
+        // Change flags according subtraction between B and A without by modifying A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.cp8(&(mainBank.af), true, &(mainBank.bc), true);
+        break;
+    }
+
+    case 0xB9:
+    {
+        // 185: CP C
+        // Change flags according subtraction between C and A without by modifying A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.cp8(&(mainBank.af), true, &(mainBank.bc), false);
+        break;
+    }
+
+    case 0xBA:
+    {
+        // 186: CP D
+        // Change flags according subtraction between D and A without by modifying A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.cp8(&(mainBank.af), true, &(mainBank.de), true);
+        break;
+    }
+
+    case 0xBB:
+    {
+        // 187: CP E
+        // Change flags according subtraction between E and A without by modifying A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.cp8(&(mainBank.af), true, &(mainBank.de), false);
+        break;
+    }
+
+    case 0xBC:
+    {
+        // 188: CP H
+        // Change flags according subtraction between H and A without by modifying A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.cp8(&(mainBank.af), true, &(hl), true);
+        break;
+    }
+
+    case 0xBD:
+    {
+        // 189: CP L
+        // Change flags according subtraction between L and A without by modifying A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.cp8(&(mainBank.af), true, &(hl), false);
+        break;
+    }
+
+    case 0xBE:
+    {
+        // 190: CP (HL)
+        // Change flags acding subtration between content of memory pointed by HL and A without by modifying A
+        // Flags affected: C, N, P, H, Z, S
+
+        auto address = indexAddress<Index>();
+        char value = (char)readByte(address);
+        clockCycles += alu.cp8(&(mainBank.af), true, value) + 3;
+        break;
+    }
+
+    case 0xBF:
+    {
+        // 191: CP A
+        // Change flags according subtraction between A and A without by modifying A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.cp8(&(mainBank.af), true, &(mainBank.af), true);
+        break;
+    }
+
+    case 0xC0: // 192: RET NZ
+    case 0xC8: // 200: RET Z
+    case 0xD0: // 208: RET NC
+    case 0xD8: // 216: RET C
+    case 0xE0: // 224: RET PO
+    case 0xE8: // 232: RET PE
+    case 0xF0: // 240: RET P
+    case 0xF8: // 248: RET M
+    {
+        // Pop the content of memory pointed by SP into PC if the condition in bits 3-5 of the opcode is true
+        // Flags affected: None
+
+        clockCycles += ret(condition((opcode >> 3) & 7));
+        break;
+    }
+
+    case 0xC1:
+    {
+        // 193: POP BC
+        // Pop the content of memory pointed by SP into BC
+        // Flags affected: None
+
+        mainBank.bc.value = read16(&sp);
+
+        clockCycles += 10;
+        break;
+    }
+
+    case 0xC2: // 194: JP NZ, **
+    case 0xCA: // 202: JP Z, **
+    case 0xD2: // 210: JP NC, **
+    case 0xDA: // 218: JP C, **
+    case 0xE2: // 226: JP PO, **
+    case 0xEA: // 234: JP PE, **
+    case 0xF2: // 242: JP P, **
+    case 0xFA: // 250: JP M, **
+    {
+        // Set PC value to ** if the condition in bits 3-5 of the opcode is true
+        // Flags affected: None
+
+        clockCycles += jp(condition((opcode >> 3) & 7));
+        break;
+    }
+
+    case 0xC3:
+    {
+        // 195: JP **
+        // Set PC value to **
+        // Flags affected: None
+
+        clockCycles += jp(true);
+        break;
+    }
+
+    case 0xC4: // 196: CALL NZ, **
+    case 0xCC: // 204: CALL Z, **
+    case 0xD4: // 212: CALL NC, **
+    case 0xDC: // 220: CALL C, **
+    case 0xE4: // 228: CALL PO, **
+    case 0xEC: // 236: CALL PE, **
+    case 0xF4: // 244: CALL P, **
+    case 0xFC: // 252: CALL M, **
+    {
+        // If the condition in bits 3-5 of the opcode is true:
+        //  - Store PC (+3) onto the stack
+        //  - Set PC value to **
+        // Flags affected: None
+
+        clockCycles += call(condition((opcode >> 3) & 7));
+        break;
+    }
+
+    case 0xC5:
+    {
+        // 197: PUSH BC
+        // Push the content of BC register into the memory location pointed by SP
+        // Flags affected: None
+
+        internalCycles(1);
+        writeByte(--sp.value, mainBank.bc.bytes.H);
+        writeByte(--sp.value, mainBank.bc.bytes.L);
+
+        clockCycles += 11;
+        break;
+    }
+
+    case 0xC6:
+    {
+        // 199: ADD A, *
+        // ADD * to A
+        // Flags affected: C, N, P, H, Z, S
+
+        char value = (char)readOperand();
+        clockCycles += alu.add8(&(mainBank.af), true, value);
+
+        clockCycles += 3;
+        break;
+    }
+
+    case 0xC7:
+    {
+        // 200: RST 00h
+        // Push PC value (+1) into the memory location pointed by SP and set PC value to 0
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += rst(0);
+        break;
+    }
+
+    case 0xC9:
+    {
+        // 201: RET
+        // Pop the content of memory pointed by SP into PC
+        // Flags affected: None
+
+        pc.value = read16(&sp);
+
+        clockCycles += 10;
+        break;
+    }
+
+    case 0xCB:
+    {
+        // 203: BITS instructions
+        // Rotations, shifts, BIT, RES and SET (see executeCB)
+        // DD CB d n / FD CB d n operate on (IX+d) / (IY+d)
+
+        if(Index == INDEX_HL)
+            clockCycles += executeCB<false>(hl.value);
+        else
+            clockCycles += executeCB<true>(indexAddress<Index>(0, 0));
+        break;
+    }
+
+    case 0xCD:
+    {
+        // 205: CALL **
+        // Push PC value (+3) into the memory location pointed by SP and set PC value to **
+        // Flags affected: None
+
+        clockCycles += call(true);
+        break;
+    }
+
+    case 0xCE:
+    {
+        // 206: ADC A, *
+        // Adds D and carry flag to A
+        // Flags affected: C, N, P, H, Z, S
+
+        char value = (char)readOperand();
+        clockCycles += alu.add8(&(mainBank.af), true, value, true) + 3;
+
+        break;
+    }
+
+    case 0xCF:
+    {
+        // 207: RST 08h
+        // Push PC value (+1) into the memory location pointed by SP and set PC value to 8
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += rst(0x08);
+        break;
+    }
+
+    case 0xD1:
+    {
+        // 209: POP DE
+        // Pop the content of memory pointed by SP into DE
+        // Flags affected: None
+
+        mainBank.de.value = read16(&sp);
+
+        clockCycles += 10;
+        break;
+    }
+
+    case 0xD3:
+    {
+        // 211: OUT (**), A
+        // Write value of A to port ** (A on the high byte of the address bus)
+        // Flags affected: None
+
+        auto port = readOperand();
+        out((mainBank.af.bytes.H << 8) | port, mainBank.af.bytes.H);
+
+        clockCycles += 11;
+        break;
+    }
+
+    case 0xD5:
+    {
+        // 213: PUSH DE
+        // Push the content of DE register into the memory location pointed by SP
+        // Flags affected: None
+
+        internalCycles(1);
+        writeByte(--sp.value, mainBank.de.bytes.H);
+        writeByte(--sp.value, mainBank.de.bytes.L);
+
+        clockCycles += 11;
+        break;
+    }
+
+    case 0xD6:
+    {
+        // 214: SUB A, *
+        // SUB * to A
+        // Flags affected: C, N, P, H, Z, S
+
+        char value = (char)readOperand();
+        clockCycles += alu.sub8(&(mainBank.af), true, value);
+
+        clockCycles += 3;
+        break;
+    }
+
+    case 0xD7:
+    {
+        // 215: RST 10h
+        // The current value of PC is pushed in SP and then is loaded with 0x10
+        // Flags affected: None
+
+        clockCycles += rst(0x10);
+        break;
+    }
+
+    case 0xD9:
+    {
+        // 217: EXX
+        // Exchange the values of the registers BC, DE, HL by BD', DE', HL'
+        // Flags affected: None
+
+        auto bc = mainBank.bc;
+        auto de = mainBank.de;
+        auto hl = mainBank.hl;
+
+        mainBank.bc = alternateBank.bc;
+        mainBank.de = alternateBank.de;
+        mainBank.hl = alternateBank.hl;
+
+        alternateBank.bc = bc;
+        alternateBank.de = de;
+        alternateBank.hl = hl;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0xDB:
+    {
+        // 219: IN A, N
+        // A byte from a port N is written to register A (A on the high byte of the address bus)
+        // Flags affected: None
+
+        auto port = readOperand();
+        mainBank.af.bytes.H = in((mainBank.af.bytes.H << 8) | port);
+
+        clockCycles += 11;
+        break;
+    }
+
+    case 0xDD:
+    {
+        // 221: IX instructions
+        // The next instruction uses IX instead of HL, IXH/IXL instead of H/L and (IX+d) instead of (HL)
+
+        clockCycles += 4;
+        refreshes++;
+        executeIndexed<INDEX_IX>(fetchByte(pc.value++));
+        break;
+    }
+
+    case 0xDE:
+    {
+        // 222: SBC A, N
+        // Subtracts B and carry flag from A
+        // Flags affected: C, N, P, H, Z, S
+
+        auto value = readOperand();
+        clockCycles += alu.sub8(&(mainBank.af), true, value, true) + 3;
+        
+        break;
+    }
+
+    case 0xDF:
+    {
+        // 223: RST 18h
+        // Push PC value (+1) into the memory location pointed by SP and set PC value to 24
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += rst(0x18);
+        break;
+    }
+
+    case 0xE1:
+    {
+        // 225: POP HL
+        // Pop the content of memory pointed by SP into BC
+        // Flags affected: None
+
+        hl.value = read16(&sp);
+
+        clockCycles += 10;
+        break;
+    }
+
+    case 0xE3:
+    {
+        // 227: EX (SP), HL
+        // Exchanges the contents of (SP) and HL
+
+        uint8_t low = readByte(sp.value);
+        uint8_t high = readByte(sp.value + 1);
+        internalCycles(1);
+        writeByte(sp.value + 1, hl.bytes.H);
+        writeByte(sp.value, hl.bytes.L);
+        internalCycles(2);
+        hl.value = low | (high << 8);
+
+        clockCycles += 19;
+        break;
+    }
+
+    case 0xE5:
+    {
+        // 229: PUSH HL
+        // Push the content of HL register into the memory location pointed by SP
+        // Flags affected: None
+
+        internalCycles(1);
+        writeByte(--sp.value, hl.bytes.H);
+        writeByte(--sp.value, hl.bytes.L);
+
+        clockCycles += 11;
+        break;
+    }
+
+    case 0xE6:
+    {
+        // 230: AND *
+        // AND operation A to A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.and8(&(mainBank.af), true, readOperand()) + 3;
+        break;
+    }
+
+    case 0xE7:
+    {
+        // 231: RST 20h
+        // Push PC value (+1) into the memory location pointed by SP and set PC value to 32
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += rst(0x20);
+        break;
+    }
+
+    case 0xE9:
+    {
+        // 233: JP (HL)
+        // Set PC value to HL (IX/IY with the prefix), despite the mnemonic no memory is read
+        // Flags affected: None
+
+        pc.value = hl.value;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0xEB:
+    {
+        // 235: EX DE, HL
+        // Exchanges the contents of DE and HL
+
+        uint16_t de = mainBank.de.value;
+        mainBank.de.value = mainBank.hl.value;
+        mainBank.hl.value = de;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0xED:
+    {
+        // 237: Misc instructions
+        // I/O, 16-bit arithmetic, interrupts and block instructions (see executeED)
+
+        clockCycles += executeED();
+        break;
+    }
+
+    case 0xEE:
+    {
+        // 238: XOR **
+        // XOR operation from ** to A
+        // Flags affected: C, N, P, H, Z, S
+
+        auto value = readOperand();
+        clockCycles += alu.xor8(&(mainBank.af), true, value) + 3;
+        break;
+    }
+
+    case 0xEF:
+    {
+        // 239: RST 28h
+        // Push PC value (+1) into the memory location pointed by SP and set PC value to 40 (0x28)
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += rst(0x28);
+        break;
+    }
+
+    case 0xF1:
+    {
+        // 241: POP AF
+        // Pop the content of memory pointed by SP into AF
+        // Flags affected: None
+
+        mainBank.af.value = read16(&sp);
+
+        clockCycles += 10;
+        break;
+    }
+
+    case 0xF3:
+    {
+        /// 243: DI
+        /// Disable interrupts temporarily
+        /// Flags affected: None
+
+        iff1 = false;
+        iff2 = false;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0xF5:
+    {
+        // 245: PUSH AF
+        // Push the content of AF register into the memory location pointed by SP
+        // Flags affected: None
+
+        internalCycles(1);
+        writeByte(--sp.value, mainBank.af.bytes.H);
+        writeByte(--sp.value, mainBank.af.bytes.L);
+
+        clockCycles += 11;
+        break;
+    }
+
+    case 0xF6:
+    {
+        // 246: OR **
+        // OR operation from ** to A
+        // Flags affected: C, N, P, H, Z, S
+
+        auto value = readOperand();
+        clockCycles += alu.or8(&(mainBank.af), true, value) + 3;
+        break;
+    }
+
+    case 0xF7:
+    {
+        // 247: RST 30h
+        // Push PC value (+1) into the memory location pointed by SP and set PC value to 48 (0x30)
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += rst(0x30);
+        break;
+    }
+
+    case 0xF9:
+    {
+        // 249: LD SP, HL
+        // Loads HL into SP
+        // Flags affected: None
+
+        sp.value = hl.value;
+
+        internalCycles(2);
+        clockCycles += 6;
+        break;
+    }
+
+    case 0xFB:
+    {
+        // 251: EI
+        // Enable interruptions after the next instruction
+        // Flags affected: None
+
+        iff1 = true;
+        iff2 = true;
+        interruptDelay = true;
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0xFD:
+    {
+        // 253: IY instructions
+        // The next instruction uses IY instead of HL, IYH/IYL instead of H/L and (IY+d) instead of (HL)
+
+        clockCycles += 4;
+        refreshes++;
+        executeIndexed<INDEX_IY>(fetchByte(pc.value++));
+        break;
+    }
+
+    case 0xFE:
+    {
+        // 254: CP **
+        // Change flags according subtraction between ** and A without modifying A
+        // Flags affected: C, N, P, H, Z, S
+
+        clockCycles += alu.cp8(&(mainBank.af), true, readOperand());
+        clockCycles += 3;
+        break;
+    }
+
+    case 0xFF:
+    {
+        // 255: RST 38h
+        // Push PC value (+1) into the memory location pointed by SP and set PC value to 0x38
+        // Flags affected:  None
+
+        clockCycles += rst(0x38);
+        break;
+    }
+
+    default:
+    {
+        break;
+    }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Execute instructions until a number of clock cycles is consumed
+ *
+ * The last instruction may exceed the budget, the extra cycles are
+ * included in the total number of clock cycles. Every iteration of a
+ * block instruction (LDIR, CPIR...) counts as one instruction.
+ *
+ * With skipIdleLoops set, loops without side effects are fast-forwarded
+ * (see skipIdleLoop) and their skipped instructions are counted as well.
+ *
+ * @param cycles budget of clock cycles
+ * @return number of executed instructions
+ */
+template<class Memory>
+uint64_t BasicCPU<Memory>::run(uint64_t cycles)
+{
+    uint64_t target = clockCycles + cycles;
+    uint64_t start = instructionCount;
+
+    if(breakpoints)
+        return runDebug(target);
+
+    // Block instructions run several iterations per call up to the deadline
+    deadline = target;
+#ifndef EMUZETA80_TIMING
+    if(skipIdleLoops)
+    {
+        while(clockCycles < target)
+        {
+            uint16_t address = pc.value;
+            execute();
+
+            // Backward branch: start of a loop
+            if(pc.value < address && address - pc.value < 256)
+                skipIdleLoop(address);
+        }
+    }
+#endif
+    while(clockCycles < target)
+        execute();
+    deadline = 0;
+
+    return instructionCount - start;
+}
+
+/**
+ * @brief Execute instructions up to a clock cycle or a stop of the Debugger
+ *
+ * Stops before the instructions at the breakpoints (except the first one,
+ * so a stopped CPU can resume) and after the instruction that set stopping.
+ * Idle loops are not skipped.
+ *
+ * @param target clock cycles at the end of the run
+ * @return number of executed instructions
+ */
+template<class Memory>
+uint64_t BasicCPU<Memory>::runDebug(uint64_t target)
+{
+    uint64_t start = instructionCount;
+
+    deadline = watching ? 0 : target;
+    while(clockCycles < target)
+    {
+        uint16_t address = pc.value;
+        if(((breakpoints[address >> 6] >> (address & 63)) & 1) && instructionCount != start)
+            break;
+
+        execute();
+        if(stopping)
+            break;
+    }
+    deadline = 0;
+
+    return instructionCount - start;
+}
+
+//-------------------------------------------------------------------------
+// CB prefix (bit instructions)
+//-------------------------------------------------------------------------
+
+namespace detail
+{
+
+/**
+ * @brief Flags S, Z, 5, 3 and P of every 8-bit result
+ */
+struct BitFlags
+{
+    uint8_t szp[256];
+
+    BitFlags()
+    {
+        for(int value = 0; value < 256; value++)
+        {
+            bool parity = true;
+            for(int bit = 0; bit < 8; bit++)
+                parity ^= ((value >> bit) & 1) != 0;
+
+            szp[value] = (value & (FLAG_S | FLAG_5 | FLAG_3)) | (value == 0 ? FLAG_Z : 0) | (parity ? FLAG_P : 0);
+        }
+    }
+};
+
+extern const BitFlags bitFlags; //< Defined in CPU.cpp
+
+/**
+ * @brief Get an 8-bit register by its index in the opcode (B, C, D, E, H, L, -, A)
+ */
+inline uint8_t& reg8(RegistersBank& bank, int index)
+{
+    switch(index)
+    {
+    case 0: return bank.bc.bytes.H;
+    case 1: return bank.bc.bytes.L;
+    case 2: return bank.de.bytes.H;
+    case 3: return bank.de.bytes.L;
+    case 4: return bank.hl.bytes.H;
+    case 5: return bank.hl.bytes.L;
+    default: return bank.af.bytes.H;
+    }
+}
+
+/**
+ * @brief Rotation or shift of a value (RLC, RRC, RL, RR, SLA, SRA, SLL, SRL)
+ *
+ * Flags affected: C, N, P, H, Z, S
+ *
+ * @param value value to rotate or shift
+ * @param flags F register, updated with the flags of the result
+ * @return rotated or shifted value
+ */
+template<int Operation>
+inline uint8_t shift(uint8_t value, uint8_t& flags)
+{
+    uint8_t carry = Operation & 1 ? value & 0x01 : value >> 7;
+    uint8_t result;
+
+    switch(Operation)
+    {
+    case 0: result = (value << 1) | carry; break;                   // RLC
+    case 1: result = (value >> 1) | (carry << 7); break;            // RRC
+    case 2: result = (value << 1) | (flags & FLAG_C); break;        // RL
+    case 3: result = (value >> 1) | ((flags & FLAG_C) << 7); break; // RR
+    case 4: result = value << 1; break;                             // SLA
+    case 5: result = (value >> 1) | (value & 0x80); break;          // SRA
+    case 6: result = (value << 1) | 0x01; break;                    // SLL (undocumented)
+    default: result = value >> 1; break;                            // SRL
+    }
+
+    flags = bitFlags.szp[result] | (carry ? FLAG_C : 0);
+    return result;
+}
+
+} // namespace detail
+
+/**
+ * @brief Execute a CB prefixed instruction
+ *
+ * The byte after the prefix selects the operation (bits 3-7) and the
+ * register (bits 0-2). Every combination has its own handler generated
+ * from CPU::cb, indexed by that byte.
+ *
+ * Indexed is true for DD CB d n and FD CB d n, which operate on (IX+d) or
+ * (IY+d) with the displacement already read.
+ *
+ * @param address address of the (HL), (IX+d) or (IY+d) operand
+ * @return number of cycles of the operation
+ */
+template<class Memory>
+template<bool Indexed>
+uint16_t BasicCPU<Memory>::executeCB(uint16_t address)
+{
+    typedef uint16_t (BasicCPU::*Handler)(uint16_t);
+
+#define CB_HANDLERS(operation)                                                                         \
+    &BasicCPU::cb<operation, 0, Indexed>, &BasicCPU::cb<operation, 1, Indexed>,                            \
+        &BasicCPU::cb<operation, 2, Indexed>, &BasicCPU::cb<operation, 3, Indexed>,                        \
+        &BasicCPU::cb<operation, 4, Indexed>, &BasicCPU::cb<operation, 5, Indexed>,                        \
+        &BasicCPU::cb<operation, 6, Indexed>, &BasicCPU::cb<operation, 7, Indexed>
+
+    static const Handler handlers[256] = {
+        CB_HANDLERS(0),  CB_HANDLERS(1),  CB_HANDLERS(2),  CB_HANDLERS(3),  CB_HANDLERS(4),  CB_HANDLERS(5),
+        CB_HANDLERS(6),  CB_HANDLERS(7),  CB_HANDLERS(8),  CB_HANDLERS(9),  CB_HANDLERS(10), CB_HANDLERS(11),
+        CB_HANDLERS(12), CB_HANDLERS(13), CB_HANDLERS(14), CB_HANDLERS(15), CB_HANDLERS(16), CB_HANDLERS(17),
+        CB_HANDLERS(18), CB_HANDLERS(19), CB_HANDLERS(20), CB_HANDLERS(21), CB_HANDLERS(22), CB_HANDLERS(23),
+        CB_HANDLERS(24), CB_HANDLERS(25), CB_HANDLERS(26), CB_HANDLERS(27), CB_HANDLERS(28), CB_HANDLERS(29),
+        CB_HANDLERS(30), CB_HANDLERS(31),
+    };
+
+#undef CB_HANDLERS
+
+    // DD CB d op / FD CB d op: the prefixes were the M1 cycles
+    refreshes += !Indexed;
+    auto opcode = Indexed ? readOperand() : fetchByte(pc.value++);
+    if(Indexed)
+        internalCycles(2);
+    return (this->*handlers[opcode])(address);
+}
+
+/**
+ * @brief CB prefixed instruction
+ *
+ * Operation 0-7: RLC, RRC, RL, RR, SLA, SRA, SLL, SRL
+ * Operation 8-15: BIT 0-7
+ * Operation 16-23: RES 0-7
+ * Operation 24-31: SET 0-7
+ *
+ * Index selects B, C, D, E, H, L, (HL) or A.
+ *
+ * The indexed forms always operate on (IX+d) or (IY+d). Except for BIT,
+ * the result is also copied to the register selected by Index
+ * (undocumented) and BIT takes flags 5 and 3 from the high byte of the
+ * address.
+ *
+ * @param address address of the (HL), (IX+d) or (IY+d) operand
+ * @return number of cycles of the operation (8, 12 for BIT b, (HL) and 15 for the rest of (HL) forms,
+ * 16 and 19 for the indexed forms without the prefix)
+ */
+template<class Memory>
+template<int Operation, int Index, bool Indexed>
+uint16_t BasicCPU<Memory>::cb(uint16_t address)
+{
+    const bool indirect = Indexed || Index == 6;
+    const uint8_t mask = 1 << (Operation & 0x07);
+    uint8_t value = indirect ? readByte(address) : detail::reg8(mainBank, Index);
+    if(indirect)
+        internalCycles(1);
+    uint8_t& flags = mainBank.af.bytes.L;
+
+    if(Operation >= 8 && Operation < 16)
+    {
+        // BIT: Z and P set if the bit is 0, S set for bit 7 if it is 1
+        // Flags affected: N, P, H, Z, S
+        uint8_t bit = value & mask;
+        uint8_t undocumented = Indexed ? address >> 8 : value;
+        flags = (flags & FLAG_C) | FLAG_H | (undocumented & (FLAG_5 | FLAG_3)) | (bit & FLAG_S) |
+                (bit ? 0 : FLAG_Z | FLAG_P);
+
+        return Indexed ? 16 : indirect ? 12 : 8;
+    }
+
+    uint8_t result;
+    if(Operation < 8)
+        result = detail::shift<Operation & 0x07>(value, flags);
+    else if(Operation < 24)
+        result = value & ~mask; // RES
+    else
+        result = value | mask; // SET
+
+    if(indirect)
+        writeByte(address, result);
+    if(Index != 6 && (!indirect || Indexed))
+        detail::reg8(mainBank, Index) = result;
+
+    return Indexed ? 19 : indirect ? 15 : 8;
+}
+
+//-------------------------------------------------------------------------
+// ED prefix (misc instructions)
+//-------------------------------------------------------------------------
+
+/**
+ * @brief Execute an ED prefixed instruction
+ *
+ * Undefined opcodes behave as two NOPs.
+ *
+ * @return number of cycles of the operation
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::executeED()
+{
+    refreshes++;
+    auto opcode = fetchByte(pc.value++);
+    uint8_t& flags = mainBank.af.bytes.L;
+    uint8_t& a = mainBank.af.bytes.H;
+
+    if(opcode >= 0x40 && opcode < 0x80)
+    {
+        int index = (opcode >> 3) & 0x07;
+        Register* pairs[] = {&mainBank.bc, &mainBank.de, &mainBank.hl, &sp};
+        Register* pair = pairs[index >> 1];
+
+        switch(opcode & 0x07)
+        {
+        case 0:
+        {
+            // IN r, (C) / IN (C) (only flags for index 6)
+            // Flags affected: N, P, H, Z, S
+            uint8_t value = in(mainBank.bc.value);
+            if(index != 6)
+                detail::reg8(mainBank, index) = value;
+            flags = detail::bitFlags.szp[value] | (flags & FLAG_C);
+            return 12;
+        }
+
+        case 1:
+        {
+            // OUT (C), r / OUT (C), 0
+            out(mainBank.bc.value, index != 6 ? detail::reg8(mainBank, index) : 0);
+            return 12;
+        }
+
+        case 2:
+        {
+            // SBC HL, rr (index even) / ADC HL, rr (index odd)
+            // Flags affected: C, N, P, H, Z, S
+            internalCycles(7);
+            int hl = mainBank.hl.value;
+            int value = pair->value;
+            int carry = flags & FLAG_C;
+            bool subtract = (index & 1) == 0;
+            int result = subtract ? hl - value - carry : hl + value + carry;
+            int half = subtract ? (hl & 0x0FFF) - (value & 0x0FFF) - carry : (hl & 0x0FFF) + (value & 0x0FFF) + carry;
+            bool overflow = subtract ? ((hl ^ value) & (hl ^ result) & 0x8000) != 0
+                                     : (~(hl ^ value) & (hl ^ result) & 0x8000) != 0;
+
+            mainBank.hl.value = (uint16_t)result;
+            flags = (mainBank.hl.bytes.H & (FLAG_S | FLAG_5 | FLAG_3)) | (mainBank.hl.value == 0 ? FLAG_Z : 0) |
+                    (half < 0 || half > 0x0FFF ? FLAG_H : 0) | (overflow ? FLAG_P : 0) | (subtract ? FLAG_N : 0) |
+                    (result < 0 || result > 0xFFFF ? FLAG_C : 0);
+            return 15;
+        }
+
+        case 3:
+        {
+            // LD (**), rr (index even) / LD rr, (**) (index odd)
+            uint16_t address = readOperand16();
+            if(index & 1)
+            {
+                Register source;
+                source.value = address;
+                pair->value = read16(&source);
+            }
+            else
+            {
+                writeByte(address, pair->bytes.L);
+                writeByte((uint16_t)(address + 1), pair->bytes.H);
+            }
+            return 20;
+        }
+
+        case 4:
+        {
+            // NEG
+            // Flags affected: C, N, P, H, Z, S
+            uint8_t value = a;
+            a = 0 - value;
+            flags = detail::bitFlags.szp[a] & ~FLAG_P;
+            flags |= FLAG_N | ((value & 0x0F) != 0 ? FLAG_H : 0) | (value == 0x80 ? FLAG_P : 0) | (value != 0 ? FLAG_C : 0);
+            return 8;
+        }
+
+        case 5:
+        {
+            // RETN / RETI
+            iff1 = iff2;
+            pc.value = read16(&sp);
+            return 14;
+        }
+
+        case 6:
+        {
+            // IM 0 / IM 1 / IM 2
+            static const uint8_t modes[] = {0, 0, 1, 2};
+            im = modes[index & 0x03];
+            return 8;
+        }
+
+        default:
+            break;
+        }
+
+        switch(opcode)
+        {
+        case 0x47: internalCycles(1); i = a; return 9; // LD I, A
+        case 0x4F: internalCycles(1); setr(a); return 9; // LD R, A
+
+        case 0x57: // LD A, I
+        case 0x5F: // LD A, R
+        {
+            // Flags affected: N, P, H, Z, S
+            internalCycles(1);
+            a = opcode == 0x57 ? i : getr();
+            flags = (detail::bitFlags.szp[a] & ~FLAG_P) | (iff2 ? FLAG_P : 0) | (flags & FLAG_C);
+            return 9;
+        }
+
+        case 0x67: // RRD
+        case 0x6F: // RLD
+        {
+            // Flags affected: N, P, H, Z, S
+            uint8_t value = readByte(mainBank.hl.value);
+            internalCycles(4);
+            if(opcode == 0x67)
+            {
+                writeByte(mainBank.hl.value, (a << 4) | (value >> 4));
+                a = (a & 0xF0) | (value & 0x0F);
+            }
+            else
+            {
+                writeByte(mainBank.hl.value, (value << 4) | (a & 0x0F));
+                a = (a & 0xF0) | (value >> 4);
+            }
+            flags = detail::bitFlags.szp[a] | (flags & FLAG_C);
+            return 18;
+        }
+
+        default:
+            return 8;
+        }
+    }
+
+    // Block instructions: A0-A3 / A8-AB / B0-B3 / B8-BB
+    if((opcode & 0xE4) != 0xA0)
+        return 8;
+
+    int delta = opcode & 0x08 ? -1 : 1;
+    bool repeat = (opcode & 0x10) != 0;
+    uint32_t count = mainBank.bc.value != 0 ? mainBank.bc.value : 0x10000;
+
+    // I/O handlers see the clock cycles of every iteration (and INIR/INDR may
+    // overwrite the instruction): one iteration per call
+    switch(opcode & 0x03)
+    {
+    case 0: return blockTransfer(delta, repeat);                    // LDI, LDD, LDIR, LDDR
+    case 1: return block(&BasicCPU::cpStep, delta, repeat, count);       // CPI, CPD, CPIR, CPDR
+    case 2: return block(&BasicCPU::inStep, delta, repeat, 1);           // INI, IND, INIR, INDR
+    default: return block(&BasicCPU::outStep, delta, repeat, 1);         // OUTI, OUTD, OTIR, OTDR
+    }
+}
+
+/**
+ * @brief Maximum number of iterations of a block instruction in one call
+ *
+ * Iterations are executed while the clock cycles are below the deadline of
+ * the current run (the same iterations that separate calls would execute).
+ * Only one iteration runs outside CPU::run or if an interrupt can be accepted.
+ *
+ * @param count remaining iterations of the instruction
+ * @return number of iterations (at least 1, at most 3000 to keep the cycles in 16 bits)
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::repeatLimit(uint32_t count)
+{
+    if(deadline <= clockCycles || (interruptPending && iff1))
+        return 1;
+
+#ifdef EMUZETA80_TIMING
+    // Every iteration reports its own machine cycles
+    return 1;
+#endif
+
+    uint64_t limit = (deadline - clockCycles + 20) / 21;
+    if(limit > count)
+        limit = count;
+    if(limit > 3000)
+        limit = 3000;
+
+    return (uint16_t)limit;
+}
+
+/**
+ * @brief Execute the iterations of a block instruction
+ *
+ * A repeating instruction that must continue sets PC back to the ED prefix,
+ * so the next call (or an interrupt) resumes it.
+ *
+ * @param step iteration of the instruction, returns true if the instruction repeats
+ * @param delta increment of HL (and DE) per iteration
+ * @param repeat true for the repeating instructions (LDIR, CPIR...)
+ * @param count remaining iterations
+ * @return number of cycles (16 for the last iteration, 21 for the rest)
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::block(bool (BasicCPU::*step)(int), int delta, bool repeat, uint32_t count)
+{
+    uint16_t iterations = repeat ? repeatLimit(count) : 1;
+
+    for(uint16_t n = 1;; n++)
+    {
+        if(!(this->*step)(delta) || !repeat)
+        {
+            instructionCount += n - 1;
+            refreshes += n - 1;
+            return 21 * (n - 1) + 16;
+        }
+
+        if(n == iterations || (interruptPending && iff1))
+        {
+            // Timing builds run one iteration per call
+            internalCycles(5);
+            pc.value -= 2;
+            instructionCount += n - 1;
+            refreshes += n - 1;
+            return 21 * n;
+        }
+    }
+}
+
+/**
+ * @brief LDI, LDD, LDIR and LDDR
+ *
+ * Repeating transfers are done with a single copy or fill of the RAM when
+ * the result is the same as copying byte by byte.
+ *
+ * @param delta increment of HL and DE per iteration
+ * @param repeat true for LDIR and LDDR
+ * @return number of cycles of the operation
+ */
+template<class Memory>
+uint16_t BasicCPU<Memory>::blockTransfer(int delta, bool repeat)
+{
+    uint16_t iterations = repeat ? repeatLimit(mainBank.bc.value != 0 ? mainBank.bc.value : 0x10000) : 1;
+
+    // Every iteration fetches the instruction again: stop at the one that overwrites it
+    for(int byte = 1; byte <= 2; byte++)
+    {
+        uint16_t offset = (uint16_t)((pc.value - byte - mainBank.de.value) * delta);
+        if(offset < iterations)
+            iterations = offset + 1;
+    }
+
+    if(iterations > 1 && bulkTransfer(delta, iterations))
+    {
+        // Flags of the last iteration
+        uint8_t n = memory->peek((uint16_t)(mainBank.de.value - delta)) + mainBank.af.bytes.H;
+        uint8_t& flags = mainBank.af.bytes.L;
+        flags = (flags & (FLAG_S | FLAG_Z | FLAG_C)) | (mainBank.bc.value != 0 ? FLAG_P : 0) | (n & FLAG_3) |
+                ((n & 0x02) ? FLAG_5 : 0);
+
+        instructionCount += iterations - 1;
+        refreshes += iterations - 1;
+        if(mainBank.bc.value == 0)
+            return 21 * (iterations - 1) + 16;
+
+        pc.value -= 2;
+        return 21 * iterations;
+    }
+
+    return block(&BasicCPU::ldStep, delta, repeat, iterations);
+}
+
+/**
+ * @brief Copy several bytes from (HL) to (DE) at once
+ *
+ * Only done if no address wraps around 0000h, the blocks don't overlap
+ * in the direction of the copy (except one byte apart, which is a fill)
+ * and the memory has no protected bytes in the target block.
+ * HL, DE and BC are updated as after the iterations.
+ *
+ * @param delta increment of HL and DE per iteration
+ * @param length number of bytes
+ * @return false if the copy must be done byte by byte
+ */
+template<class Memory>
+bool BasicCPU<Memory>::bulkTransfer(int delta, uint16_t length)
+{
+    int source = mainBank.hl.value;
+    int target = mainBank.de.value;
+    int sourceStart = delta > 0 ? source : source - length + 1;
+    int targetStart = delta > 0 ? target : target - length + 1;
+
+    if(sourceStart < 0 || targetStart < 0 || sourceStart + length > 0x10000 || targetStart + length > 0x10000)
+        return false;
+
+    // ROM regions and buses with custom writes
+    if(memory->isProtected(targetStart, length))
+        return false;
+
+    int distance = (target - source) * delta;
+    if(distance == 1)
+        memory->fill(targetStart, memory->peek(source), length);
+    else if(distance > 1 && distance < length)
+        return false;
+    else
+        memory->copy(targetStart, sourceStart, length);
+
+    mainBank.hl.value += delta * length;
+    mainBank.de.value += delta * length;
+    mainBank.bc.value -= length;
+
+    return true;
+}
+
+/**
+ * @brief One iteration of LDI/LDD
+ *
+ * Flags affected: N, P, H, 5, 3
+ *
+ * @return true if BC is not 0
+ */
+template<class Memory>
+bool BasicCPU<Memory>::ldStep(int delta)
+{
+    uint8_t value = readByte(mainBank.hl.value);
+    writeByte(mainBank.de.value, value);
+    internalCycles(2);
+    mainBank.hl.value += delta;
+    mainBank.de.value += delta;
+    mainBank.bc.value--;
+
+    uint8_t n = value + mainBank.af.bytes.H;
+    uint8_t& flags = mainBank.af.bytes.L;
+    flags = (flags & (FLAG_S | FLAG_Z | FLAG_C)) | (mainBank.bc.value != 0 ? FLAG_P : 0) | (n & FLAG_3) |
+            ((n & 0x02) ? FLAG_5 : 0);
+
+    return mainBank.bc.value != 0;
+}
+
+/**
+ * @brief One iteration of CPI/CPD
+ *
+ * Flags affected: N, P, H, Z, S, 5, 3
+ *
+ * @return true if BC is not 0 and A is not equal to (HL)
+ */
+template<class Memory>
+bool BasicCPU<Memory>::cpStep(int delta)
+{
+    uint8_t value = readByte(mainBank.hl.value);
+    internalCycles(5);
+    mainBank.hl.value += delta;
+    mainBank.bc.value--;
+
+    uint8_t a = mainBank.af.bytes.H;
+    uint8_t result = a - value;
+    bool half = (a & 0x0F) < (value & 0x0F);
+    uint8_t n = result - (half ? 1 : 0);
+    uint8_t& flags = mainBank.af.bytes.L;
+    flags = (flags & FLAG_C) | FLAG_N | (result & FLAG_S) | (result == 0 ? FLAG_Z : 0) | (half ? FLAG_H : 0) |
+            (mainBank.bc.value != 0 ? FLAG_P : 0) | (n & FLAG_3) | ((n & 0x02) ? FLAG_5 : 0);
+
+    return mainBank.bc.value != 0 && result != 0;
+}
+
+/**
+ * @brief One iteration of INI/IND
+ *
+ * Flags affected: C, N, P, H, Z, S
+ *
+ * @return true if B is not 0
+ */
+template<class Memory>
+bool BasicCPU<Memory>::inStep(int delta)
+{
+    internalCycles(1);
+    uint8_t value = in(mainBank.bc.value);
+    writeByte(mainBank.hl.value, value);
+    mainBank.hl.value += delta;
+    mainBank.bc.bytes.H--;
+
+    int k = value + (uint8_t)(mainBank.bc.bytes.L + delta);
+    uint8_t b = mainBank.bc.bytes.H;
+    mainBank.af.bytes.L = (detail::bitFlags.szp[b] & ~FLAG_P) | (value & 0x80 ? FLAG_N : 0) | (k > 0xFF ? FLAG_H | FLAG_C : 0) |
+                          (detail::bitFlags.szp[(k & 0x07) ^ b] & FLAG_P);
+
+    return b != 0;
+}
+
+/**
+ * @brief One iteration of OUTI/OUTD
+ *
+ * Flags affected: C, N, P, H, Z, S
+ *
+ * @return true if B is not 0
+ */
+template<class Memory>
+bool BasicCPU<Memory>::outStep(int delta)
+{
+    internalCycles(1);
+    uint8_t value = readByte(mainBank.hl.value);
+    mainBank.bc.bytes.H--;
+    out(mainBank.bc.value, value);
+    mainBank.hl.value += delta;
+
+    int k = value + mainBank.hl.bytes.L;
+    uint8_t b = mainBank.bc.bytes.H;
+    mainBank.af.bytes.L = (detail::bitFlags.szp[b] & ~FLAG_P) | (value & 0x80 ? FLAG_N : 0) | (k > 0xFF ? FLAG_H | FLAG_C : 0) |
+                          (detail::bitFlags.szp[(k & 0x07) ^ b] & FLAG_P);
+
+    return b != 0;
+}
+
+//-------------------------------------------------------------------------
+// Idle loops
+//-------------------------------------------------------------------------
+
+namespace detail
+{
+
+/**
+ * @brief Instructions that can be part of an idle loop
+ *
+ * Idle instructions do not write memory, do not access I/O ports or the
+ * stack and do not change the interrupt state, so repeating them with the
+ * same registers gives the same result as long as the memory reads have
+ * no side effects (see hasPureReads of the memory).
+ */
+struct IdleInstructions
+{
+    bool idle[256];  //< unprefixed opcode without side effects
+    bool usesB[256]; //< unprefixed opcode that reads or writes B (besides DJNZ)
+
+    IdleInstructions()
+    {
+        for(int opcode = 0; opcode < 256; opcode++)
+        {
+            int low = opcode & 0x0F;
+            bool load = opcode >= 0x40 && opcode < 0x80 && (opcode < 0x70 || opcode >= 0x78) && opcode != 0x76;
+            bool alu = opcode >= 0x80 && opcode < 0xC0;
+
+            idle[opcode] = load || alu || (opcode < 0x40 && low != 0x02 && low != 0x08 && opcode != 0x34 &&
+                                          opcode != 0x35 && opcode != 0x36);
+            usesB[opcode] = (opcode >= 0x01 && opcode <= 0x0B && opcode != 0x02 && opcode != 0x07 && opcode != 0x08) ||
+                            (opcode >= 0x40 && opcode < 0x48) || ((load || alu) && (opcode & 0x07) == 0);
+        }
+
+        // EX AF, AF' / JR / JR Z / JR C
+        idle[0x08] = idle[0x18] = idle[0x28] = idle[0x38] = true;
+
+        // JP nn / JP cc, nn / ALU A, n / EX DE, HL / EXX / LD SP, HL
+        const uint8_t others[] = {0xC3, 0xC2, 0xCA, 0xD2, 0xDA, 0xE2, 0xEA, 0xF2, 0xFA, 0xC6,
+                                  0xCE, 0xD6, 0xDE, 0xE6, 0xEE, 0xF6, 0xFE, 0xEB, 0xD9, 0xF9};
+        for(auto opcode : others)
+            idle[opcode] = true;
+        usesB[0xD9] = true;
+    }
+};
+
+extern const IdleInstructions idleInstructions; //< Defined in CPU.cpp
+
+/**
+ * @brief Compare the registers of two snapshots (except the clock cycles and R)
+ *
+ * @param ignoreB true to skip the comparison of B
+ */
+inline bool sameState(const Snapshot& a, const Snapshot& b, bool ignoreB)
+{
+    const RegistersBank* banks[] = {&a.mainBank, &b.mainBank, &a.alternateBank, &b.alternateBank};
+    for(int bank = 0; bank < 4; bank += 2)
+    {
+        if(banks[bank]->af.value != banks[bank + 1]->af.value || banks[bank]->de.value != banks[bank + 1]->de.value ||
+           banks[bank]->hl.value != banks[bank + 1]->hl.value || banks[bank]->bc.bytes.L != banks[bank + 1]->bc.bytes.L)
+            return false;
+    }
+
+    return (ignoreB || a.mainBank.bc.bytes.H == b.mainBank.bc.bytes.H) &&
+           a.alternateBank.bc.bytes.H == b.alternateBank.bc.bytes.H && a.pc.value == b.pc.value &&
+           a.sp.value == b.sp.value && a.iX.value == b.iX.value && a.iY.value == b.iY.value && a.i == b.i &&
+           a.iff1 == b.iff1 && a.iff2 == b.iff2 && a.im == b.im &&
+           a.interruptDelay == b.interruptDelay;
+}
+
+} // namespace detail
+
+/**
+ * @brief Fast-forward a loop without side effects
+ *
+ * Called after a backward branch to PC. One iteration of the loop is
+ * executed instruction by instruction while every instruction is an idle
+ * one (see IdleInstructions). If the registers are the same after the
+ * iteration, the loop waits for a change that can only come from an
+ * event or interrupt, so whole iterations are skipped up to the deadline.
+ * If only B was decremented by one (DJNZ delay loop without other uses
+ * of B), the remaining iterations before the last one are skipped in
+ * closed form. Nothing is skipped unless the memory declares its reads
+ * pure (plain RAM without read watchpoints), as a bus or a watched page
+ * may count or report every read.
+ *
+ * The skipped instructions are added to the instruction counter (and their
+ * prefixes to R).
+ *
+ * @param branch address of the branch instruction (end of the loop)
+ */
+template<class Memory>
+void BasicCPU<Memory>::skipIdleLoop(uint16_t branch)
+{
+    const uint16_t start = pc.value;
+    const uint64_t maximum = 64;
+    uint64_t executed = 0;
+    bool usesB = false;
+
+    if((interruptPending && iff1) || !memory->hasPureReads())
+        return;
+
+    Snapshot before;
+    save(before);
+    uint8_t prefixes = refreshes;
+
+    do
+    {
+        uint8_t opcode = memory->fetch(pc.value);
+        bool idle = detail::idleInstructions.idle[opcode];
+        if(opcode == 0xCB)
+        {
+            // Bit instructions on registers, BIT b, (HL)
+            uint8_t operation = memory->fetch((uint16_t)(pc.value + 1));
+            idle = (operation & 0x07) != 6 || (operation >= 0x40 && operation < 0x80);
+            usesB = usesB || (operation & 0x07) == 0;
+        }
+        else
+        {
+            usesB = usesB || detail::idleInstructions.usesB[opcode];
+        }
+
+        if(!idle || pc.value < start || pc.value > branch || executed == maximum || clockCycles >= deadline)
+            return;
+
+        execute();
+        executed++;
+    } while(pc.value != start);
+
+    // The branch of the probe iteration may have reached the deadline
+    if(clockCycles >= deadline)
+        return;
+
+    Snapshot after;
+    save(after);
+
+    uint64_t length = after.clockCycles - before.clockCycles;
+    uint64_t iterations = (deadline - clockCycles) / length;
+
+    if(!detail::sameState(before, after, true))
+        return;
+
+    if(mainBank.bc.bytes.H != before.mainBank.bc.bytes.H)
+    {
+        // DJNZ: identical iterations until B reaches 1
+        if(usesB || (uint8_t)(before.mainBank.bc.bytes.H - 1) != mainBank.bc.bytes.H)
+            return;
+
+        uint64_t remaining = (mainBank.bc.bytes.H == 0 ? 256 : mainBank.bc.bytes.H) - 1;
+        if(iterations > remaining)
+            iterations = remaining;
+        mainBank.bc.bytes.H -= iterations;
+    }
+
+    clockCycles += iterations * length;
+    instructionCount += executed * iterations;
+    refreshes += (uint8_t)(refreshes - prefixes) * iterations;
+}
+
+} // namespace emuzeta80
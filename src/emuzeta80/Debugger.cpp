@@ -0,0 +1,241 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Debugger.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Debugger class to run a CPU with breakpoints and watchpoints
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include "Debugger.h"
+
+//-------------------------------------------------------------------------
+// Class implementation
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Construct a new Debugger instance (no breakpoints or watchpoints)
+ *
+ * @param cpu CPU to run
+ */
+Debugger::Debugger(CPU* cpu)
+{
+    this->cpu = cpu;
+    breakpoints.assign(0x10000 / 64, 0);
+    breakpointCount = 0;
+    watchpoints.assign(0x10000, 0);
+    watchedBytes = 0;
+    stopReason = STOP_NONE;
+    stopAddress = 0;
+
+    cpu->memory->setWatchCallback(&Debugger::onAccess, this);
+}
+
+/**
+ * @brief Remove the watchpoints from the RAM
+ */
+Debugger::~Debugger()
+{
+    clear();
+    cpu->memory->setWatchCallback(nullptr, nullptr);
+}
+
+/**
+ * @brief Stop before executing the instruction at an address
+ */
+void Debugger::addBreakpoint(uint16_t address)
+{
+    uint64_t bit = uint64_t(1) << (address & 63);
+    if(!(breakpoints[address >> 6] & bit))
+        breakpointCount++;
+    breakpoints[address >> 6] |= bit;
+}
+
+/**
+ * @brief Remove the breakpoint at an address (if any)
+ */
+void Debugger::removeBreakpoint(uint16_t address)
+{
+    uint64_t bit = uint64_t(1) << (address & 63);
+    if(breakpoints[address >> 6] & bit)
+        breakpointCount--;
+    breakpoints[address >> 6] &= ~bit;
+}
+
+/**
+ * @brief Check if there is a breakpoint at an address
+ */
+bool Debugger::hasBreakpoint(uint16_t address)
+{
+    return (breakpoints[address >> 6] >> (address & 63)) & 1;
+}
+
+/**
+ * @brief Stop after the instructions that read and/or write a region
+ *
+ * @param address first byte of the region
+ * @param length number of bytes (the region ends at FFFFh)
+ * @param read true to stop on reads
+ * @param write true to stop on writes
+ */
+void Debugger::addWatchpoint(uint16_t address, uint32_t length, bool read, bool write)
+{
+    uint8_t mode = (read ? RAM::PAGE_WATCH_READ : 0) | (write ? RAM::PAGE_WATCH_WRITE : 0);
+    for(uint32_t position = address; position < 0x10000 && position < address + length; position++)
+    {
+        watchedBytes += (watchpoints[position] == 0) - ((watchpoints[position] | mode) == 0);
+        watchpoints[position] |= mode;
+    }
+    updatePages(address, length);
+}
+
+/**
+ * @brief Remove the watchpoints of a region
+ *
+ * @param address first byte of the region
+ * @param length number of bytes
+ */
+void Debugger::removeWatchpoint(uint16_t address, uint32_t length)
+{
+    for(uint32_t position = address; position < 0x10000 && position < address + length; position++)
+    {
+        watchedBytes -= watchpoints[position] != 0;
+        watchpoints[position] = 0;
+    }
+    updatePages(address, length);
+}
+
+/**
+ * @brief Remove every breakpoint and watchpoint
+ */
+void Debugger::clear()
+{
+    breakpoints.assign(breakpoints.size(), 0);
+    breakpointCount = 0;
+    removeWatchpoint(0, 0x10000);
+}
+
+/**
+ * @brief Run the CPU for a number of clock cycles or until it stops
+ *
+ * @param cycles clock cycles to run (the last instruction may exceed them)
+ * @return number of executed instructions
+ */
+uint64_t Debugger::run(uint64_t cycles)
+{
+    // Accesses of the host to watched bytes do not stop the CPU
+    stopReason = STOP_NONE;
+    cpu->stopping = false;
+    if(breakpointCount == 0 && watchedBytes == 0)
+        return cpu->run(cycles);
+
+    cpu->breakpoints = breakpoints.data();
+    cpu->watching = watchedBytes != 0;
+    uint64_t instructions = cpu->run(cycles);
+    cpu->breakpoints = nullptr;
+    cpu->watching = false;
+    cpu->stopping = false;
+
+    if(stopReason == STOP_NONE && instructions > 0 && hasBreakpoint(cpu->pc.value))
+    {
+        stopReason = STOP_BREAKPOINT;
+        stopAddress = cpu->pc.value;
+    }
+
+    return instructions;
+}
+
+/**
+ * @brief Execute one instruction (one iteration of the block instructions)
+ *
+ * Breakpoints are ignored; the stop reason tells if a watched byte was accessed.
+ *
+ * @return number of clock cycles
+ */
+uint16_t Debugger::step()
+{
+    stopReason = STOP_NONE;
+    cpu->stopping = false;
+    uint16_t cycles = cpu->execute();
+    cpu->stopping = false;
+
+    return cycles;
+}
+
+/**
+ * @brief Get the reason of the end of the last run() or step()
+ */
+Debugger::StopReason Debugger::getStopReason()
+{
+    return stopReason;
+}
+
+/**
+ * @brief Get the address of the breakpoint or the watched byte that stopped the CPU
+ */
+uint16_t Debugger::getStopAddress()
+{
+    return stopAddress;
+}
+
+/**
+ * @brief Watch callback of the RAM: filter the accesses to the watched bytes
+ */
+void Debugger::onAccess(void* context, uint16_t address, uint8_t value, bool write)
+{
+    (void) value;
+    Debugger* debugger = static_cast<Debugger*>(context);
+    uint8_t mode = write ? RAM::PAGE_WATCH_WRITE : RAM::PAGE_WATCH_READ;
+    if((debugger->watchpoints[address] & mode) && debugger->stopReason == STOP_NONE)
+    {
+        debugger->stopReason = write ? STOP_WRITE : STOP_READ;
+        debugger->stopAddress = address;
+        debugger->cpu->stopping = true;
+    }
+}
+
+/**
+ * @brief Switch the pages of a region to the watch slow path (or back)
+ */
+void Debugger::updatePages(uint16_t address, uint32_t length)
+{
+    uint32_t last = address + length - 1;
+    if(length == 0)
+        return;
+    if(last > 0xFFFF)
+        last = 0xFFFF;
+
+    for(uint32_t page = address >> 8; page <= (last >> 8); page++)
+    {
+        uint8_t mode = 0;
+        for(uint32_t position = page << 8; position < (page + 1) << 8; position++)
+            mode |= watchpoints[position];
+        cpu->memory->watch(page << 8, RAM::PAGE_SIZE, (mode & RAM::PAGE_WATCH_READ) != 0,
+                           (mode & RAM::PAGE_WATCH_WRITE) != 0);
+    }
+}
+
+} // namespace emuzeta80
@@ -0,0 +1,97 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Debugger.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Debugger class to run a CPU with breakpoints and watchpoints
+ *
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <cstdint>
+#include <vector>
+
+#include "CPU.h"
+
+//-------------------------------------------------------------------------
+// Class definition
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Runs a CPU until it reaches a breakpoint or accesses a watchpoint
+ *
+ * Breakpoints are a 64 KiB bitmap tested by CPU::run before every
+ * instruction (inside the interpreter loop, so the test is the only
+ * cost); run() stops before executing an instruction at a breakpoint,
+ * except the first one (so a stopped CPU can be resumed), or when the
+ * budget ends at one. Without breakpoints and watchpoints the bitmap is
+ * not tested.
+ *
+ * Watchpoints switch only their pages of RAM to the watch slow path (see
+ * RAM::watch); run() stops after the instruction that accessed a watched
+ * byte as data (opcode and operand fetches are not reported). While there are watchpoints the block instructions run one
+ * iteration per step. The Debugger owns the watch callback of the RAM.
+ */
+class Debugger
+{
+public:
+    enum StopReason
+    {
+        STOP_NONE,       //< The cycle budget was reached
+        STOP_BREAKPOINT, //< PC reached a breakpoint (stop address)
+        STOP_READ,       //< A watched byte was read (stop address)
+        STOP_WRITE       //< A watched byte was written (stop address)
+    };
+
+    Debugger(CPU* cpu);
+    ~Debugger();
+
+    void addBreakpoint(uint16_t address);
+    void removeBreakpoint(uint16_t address);
+    bool hasBreakpoint(uint16_t address);
+    void addWatchpoint(uint16_t address, uint32_t length, bool read, bool write);
+    void removeWatchpoint(uint16_t address, uint32_t length);
+    void clear();
+    uint64_t run(uint64_t cycles);
+    uint16_t step();
+    StopReason getStopReason();
+    uint16_t getStopAddress();
+
+protected:
+    static void onAccess(void* context, uint16_t address, uint8_t value, bool write);
+    void updatePages(uint16_t address, uint32_t length);
+
+    CPU* cpu;
+    std::vector<uint64_t> breakpoints; //< bit per address
+    unsigned breakpointCount;
+    std::vector<uint8_t> watchpoints;  //< RAM::PAGE_WATCH_READ/WRITE per address
+    unsigned watchedBytes;
+    StopReason stopReason;
+    uint16_t stopAddress;
+};
+
+} // namespace emuzeta80
@@ -0,0 +1,202 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Farm.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Farm class to run many independent simulations of one program
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include "Farm.h"
+
+//-------------------------------------------------------------------------
+// Class implementation
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Construct a new Farm instance
+ *
+ * Create the memory image shared by all the jobs and a pool of workers,
+ * each one with its own CPU. The calling thread of run() works as worker 0,
+ * so only workers - 1 threads are started.
+ *
+ * @param image bytes of the program
+ * @param imageSize number of bytes of the program
+ * @param imageAddress memory address of the first byte of the program
+ * @param workers number of workers (0: one per hardware thread)
+ */
+Farm::Farm(const uint8_t* image, uint64_t imageSize, uint16_t imageAddress, unsigned workers)
+{
+    this->image.assign(0x10000, 0);
+    for(uint64_t i = 0; i < imageSize && imageAddress + i < 0x10000; i++)
+        this->image[imageAddress + i] = image[i];
+
+    if(workers == 0)
+        workers = std::thread::hardware_concurrency();
+    if(workers == 0)
+        workers = 1;
+
+    workerCount = workers;
+    this->workers.reset(new Worker[workerCount]);
+    for(unsigned index = 0; index < workerCount; index++)
+    {
+        this->workers[index].cpu.reset(new CPU(0x10000));
+        this->workers[index].next = 0;
+        this->workers[index].end = 0;
+    }
+
+    for(unsigned index = 1; index < workerCount; index++)
+        this->workers[index].thread = std::thread(&Farm::loop, this, index);
+}
+
+/**
+ * @brief Destroy the Farm instance stopping all the workers
+ */
+Farm::~Farm()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    started.notify_all();
+
+    for(unsigned index = 1; index < workerCount; index++)
+        workers[index].thread.join();
+}
+
+/**
+ * @brief Get the number of workers of the pool
+ *
+ * @return number of workers
+ */
+unsigned Farm::getWorkers()
+{
+    return workerCount;
+}
+
+/**
+ * @brief Run a batch of jobs
+ *
+ * The jobs are split in contiguous ranges, one per worker. A worker that
+ * finishes its range steals jobs from the ranges of the other workers.
+ * No memory is allocated while the jobs run.
+ *
+ * @param jobs array of job descriptors
+ * @param results preallocated array receiving the result of every job
+ * @param count number of jobs
+ */
+void Farm::run(const FarmJob* jobs, FarmResult* results, uint64_t count)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->jobs = jobs;
+        this->results = results;
+
+        for(unsigned index = 0; index < workerCount; index++)
+        {
+            workers[index].next = count * index / workerCount;
+            workers[index].end = count * (index + 1) / workerCount;
+        }
+
+        pending = workerCount - 1;
+        generation++;
+    }
+    started.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]() { return pending == 0; });
+}
+
+/**
+ * @brief Main loop of the threads of the pool
+ *
+ * @param index index of the worker
+ */
+void Farm::loop(unsigned index)
+{
+    uint64_t seen = 0;
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            started.wait(lock, [&]() { return stopping || generation != seen; });
+            if(stopping)
+                return;
+            seen = generation;
+        }
+
+        work(index);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+        }
+        finished.notify_one();
+    }
+}
+
+/**
+ * @brief Run the range of jobs of a worker and then steal from the others
+ *
+ * @param index index of the worker
+ */
+void Farm::work(unsigned index)
+{
+    CPU& cpu = *workers[index].cpu;
+
+    for(unsigned offset = 0; offset < workerCount; offset++)
+    {
+        Worker& victim = workers[(index + offset) % workerCount];
+        for(uint64_t job = victim.next++; job < victim.end; job = victim.next++)
+            runJob(cpu, jobs[job], results[job]);
+    }
+}
+
+/**
+ * @brief Run a single job on the CPU of a worker
+ *
+ * @param cpu CPU of the worker
+ * @param job job descriptor
+ * @param result result of the job
+ */
+void Farm::runJob(CPU& cpu, const FarmJob& job, FarmResult& result)
+{
+    cpu.memory->load(0, image.data(), image.size());
+    if(job.input != nullptr)
+        cpu.memory->load(job.inputAddress, job.input, job.inputSize);
+
+    cpu.restore(job.initial);
+    result.instructions = cpu.run(job.cycles);
+    cpu.save(result.state);
+
+    if(job.output != nullptr)
+        cpu.memory->save(job.outputAddress, job.output, job.outputSize);
+}
+
+} // namespace emuzeta80
@@ -0,0 +1,114 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Farm.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Farm class to run many independent simulations of one program
+ *
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CPU.h"
+#include "Snapshot.h"
+
+//-------------------------------------------------------------------------
+// Class definition
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Descriptor of one simulation
+ *
+ * The memory is reset to the image of the farm, the input bytes are copied
+ * into memory and the registers are set from the initial snapshot. After the
+ * cycle budget is consumed, the output region of memory is copied into the
+ * output buffer (if any).
+ */
+struct FarmJob
+{
+    Snapshot initial = Snapshot();
+    const uint8_t* input = nullptr;
+    uint16_t inputAddress = 0;
+    uint16_t inputSize = 0;
+    uint64_t cycles = 0;
+    uint8_t* output = nullptr;
+    uint16_t outputAddress = 0;
+    uint16_t outputSize = 0;
+};
+
+struct FarmResult
+{
+    Snapshot state;        //< registers at the end of the job
+    uint64_t instructions; //< number of executed instructions
+};
+
+class Farm
+{
+public:
+    Farm(const uint8_t* image, uint64_t imageSize, uint16_t imageAddress = 0, unsigned workers = 0);
+    ~Farm();
+
+    void run(const FarmJob* jobs, FarmResult* results, uint64_t count);
+    unsigned getWorkers();
+
+protected:
+    // Cache line aligned: cursors of different workers never share a line
+    struct alignas(64) Worker
+    {
+        std::unique_ptr<CPU> cpu;
+        std::atomic<uint64_t> next; //< next job of the range (shared with thieves)
+        uint64_t end;               //< end of the range of jobs
+        std::thread thread;
+    };
+
+    void loop(unsigned index);
+    void work(unsigned index);
+    void runJob(CPU& cpu, const FarmJob& job, FarmResult& result);
+
+    std::vector<uint8_t> image;
+    unsigned workerCount;
+    std::unique_ptr<Worker[]> workers;
+
+    std::mutex mutex;
+    std::condition_variable started;
+    std::condition_variable finished;
+    uint64_t generation = 0;
+    unsigned pending = 0;
+    bool stopping = false;
+
+    const FarmJob* jobs = nullptr;
+    FarmResult* results = nullptr;
+};
+
+} // namespace emuzeta80
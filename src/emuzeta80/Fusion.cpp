@@ -0,0 +1,472 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Fusion.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Fusion class to run frequent instruction pairs in one dispatch
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+
+#include "Fusion.h"
+
+//-------------------------------------------------------------------------
+// Helpers
+//-------------------------------------------------------------------------
+
+namespace
+{
+
+using namespace emuzeta80;
+
+/**
+ * @brief Handlers of the fused pairs
+ */
+enum Handler
+{
+    FUSED_NONE,
+    FUSED_LOAD_INCREMENT,     //< LD A,(rr) + INC rr
+    FUSED_STORE_INCREMENT,    //< LD (rr),A + INC rr
+    FUSED_DECREMENT_BRANCH,   //< DEC r + JR/JP Z/NZ
+    FUSED_COMPARE_BRANCH,     //< CP n + JR/JP Z/NZ
+    FUSED_PUSH_PUSH,          //< PUSH rr + PUSH rr
+    FUSED_POP_POP             //< POP rr + POP rr
+};
+
+/**
+ * @brief Check if an opcode is a jump on the zero flag (JR Z/NZ, JP Z/NZ)
+ */
+bool isBranch(uint8_t opcode)
+{
+    return opcode == 0x20 || opcode == 0x28 || opcode == 0xC2 || opcode == 0xCA;
+}
+
+/**
+ * @brief Get the handler of a pair of opcodes
+ *
+ * @return handler (FUSED_NONE if the pair is not supported)
+ */
+Handler handlerOf(uint8_t first, uint8_t second)
+{
+    // LD A,(BC) / LD A,(DE) / LD A,(HL) followed by INC of the same register
+    if((first == 0x0A && second == 0x03) || (first == 0x1A && second == 0x13) || (first == 0x7E && second == 0x23))
+        return FUSED_LOAD_INCREMENT;
+
+    if((first == 0x02 && second == 0x03) || (first == 0x12 && second == 0x13) || (first == 0x77 && second == 0x23))
+        return FUSED_STORE_INCREMENT;
+
+    // DEC r (but DEC (HL))
+    if((first & 0xC7) == 0x05 && first != 0x35 && isBranch(second))
+        return FUSED_DECREMENT_BRANCH;
+
+    if(first == 0xFE && isBranch(second))
+        return FUSED_COMPARE_BRANCH;
+
+    if((first & 0xCF) == 0xC5 && (second & 0xCF) == 0xC5)
+        return FUSED_PUSH_PUSH;
+
+    if((first & 0xCF) == 0xC1 && (second & 0xCF) == 0xC1)
+        return FUSED_POP_POP;
+
+    return FUSED_NONE;
+}
+
+/**
+ * @brief Get the register addressed by LD A,(rr) and LD (rr),A
+ */
+Register& pointerOf(CPU* cpu, uint8_t opcode)
+{
+    if(opcode == 0x7E || opcode == 0x77)
+        return cpu->mainBank.hl;
+
+    return (opcode & 0x10) ? cpu->mainBank.de : cpu->mainBank.bc;
+}
+
+/**
+ * @brief Get the register of PUSH rr and POP rr (bits 4-5: BC, DE, HL, AF)
+ */
+Register& stackRegisterOf(CPU* cpu, uint8_t opcode)
+{
+    switch((opcode >> 4) & 3)
+    {
+    case 0:
+        return cpu->mainBank.bc;
+    case 1:
+        return cpu->mainBank.de;
+    case 2:
+        return cpu->mainBank.hl;
+    default:
+        return cpu->mainBank.af;
+    }
+}
+
+} // namespace
+
+//-------------------------------------------------------------------------
+// Class implementation
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Construct a new Fusion instance (no pairs enabled)
+ *
+ * @param cpu CPU to run
+ */
+Fusion::Fusion(CPU* cpu)
+{
+    this->cpu = cpu;
+    histogram.resize(0x10000);
+    handlers.resize(0x10000);
+    disable();
+}
+
+/**
+ * @brief Run the CPU one instruction at a time counting the opcode pairs
+ *
+ * The counts are added to the ones of previous calls (clearProfile).
+ *
+ * @param cycles clock cycles to run (the last instruction may exceed them)
+ * @return number of executed instructions
+ */
+uint64_t Fusion::profile(uint64_t cycles)
+{
+    uint64_t target = cpu->clockCycles + cycles;
+    uint64_t start = cpu->instructionCount;
+    int previous = -1;
+
+    cpu->deadline = target;
+    while(cpu->clockCycles < target)
+    {
+        uint8_t opcode = cpu->memory->fetch(cpu->pc.value);
+        bool accepted = cpu->interruptPending && cpu->iff1 && !cpu->interruptDelay;
+
+        cpu->execute();
+
+        // Interrupts break the sequence of instructions
+        if(accepted)
+        {
+            previous = -1;
+            continue;
+        }
+
+        if(previous >= 0)
+            histogram[previous << 8 | opcode]++;
+        previous = opcode;
+    }
+    cpu->deadline = 0;
+
+    return cpu->instructionCount - start;
+}
+
+/**
+ * @brief Get the number of times an instruction was followed by another one
+ *
+ * @param first opcode of the first instruction
+ * @param second opcode of the second instruction
+ * @return count collected by profile()
+ */
+uint64_t Fusion::getCount(uint8_t first, uint8_t second)
+{
+    return histogram[first << 8 | second];
+}
+
+/**
+ * @brief Reset the counts of the opcode pairs
+ */
+void Fusion::clearProfile()
+{
+    std::fill(histogram.begin(), histogram.end(), 0);
+}
+
+/**
+ * @brief Enable the most frequent supported pairs of the profile
+ *
+ * The pairs enabled before are disabled.
+ *
+ * @param pairs maximum number of pairs to enable
+ * @return number of enabled pairs (pairs never executed are not enabled)
+ */
+unsigned Fusion::configure(unsigned pairs)
+{
+    disable();
+
+    std::vector<unsigned> candidates;
+    for(unsigned pair = 0; pair < histogram.size(); pair++)
+    {
+        if(histogram[pair] != 0 && isSupported(pair >> 8, pair & 0xFF))
+            candidates.push_back(pair);
+    }
+
+    if(pairs > candidates.size())
+        pairs = candidates.size();
+
+    std::partial_sort(candidates.begin(), candidates.begin() + pairs, candidates.end(),
+                      [this](unsigned a, unsigned b) { return histogram[a] > histogram[b]; });
+
+    for(unsigned index = 0; index < pairs; index++)
+        enable(candidates[index] >> 8, candidates[index] & 0xFF);
+
+    return pairs;
+}
+
+/**
+ * @brief Enable the fusion of a pair of instructions
+ *
+ * @param first opcode of the first instruction
+ * @param second opcode of the second instruction
+ * @return false if the pair is not supported
+ */
+bool Fusion::enable(uint8_t first, uint8_t second)
+{
+    Handler handler = handlerOf(first, second);
+    if(handler == FUSED_NONE)
+        return false;
+
+    handlers[first << 8 | second] = handler;
+    lengths[first] = handler == FUSED_COMPARE_BRANCH ? 2 : 1;
+
+    return true;
+}
+
+/**
+ * @brief Check if the fusion of a pair of instructions is enabled
+ *
+ * @param first opcode of the first instruction
+ * @param second opcode of the second instruction
+ * @return true if the pair runs with one handler
+ */
+bool Fusion::isEnabled(uint8_t first, uint8_t second)
+{
+    return handlers[first << 8 | second] != FUSED_NONE;
+}
+
+/**
+ * @brief Disable the fusion of every pair
+ */
+void Fusion::disable()
+{
+    std::fill(handlers.begin(), handlers.end(), FUSED_NONE);
+    memset(lengths, 0, sizeof(lengths));
+}
+
+/**
+ * @brief Check if a pair of instructions can be fused
+ *
+ * @param first opcode of the first instruction
+ * @param second opcode of the second instruction
+ * @return true if there is a handler for the pair
+ */
+bool Fusion::isSupported(uint8_t first, uint8_t second)
+{
+    return handlerOf(first, second) != FUSED_NONE;
+}
+
+/**
+ * @brief Run the CPU for a number of clock cycles fusing the enabled pairs
+ *
+ * @param cycles clock cycles to run (the last instruction may exceed them)
+ * @return number of executed instructions (a fused pair counts as two)
+ */
+uint64_t Fusion::run(uint64_t cycles)
+{
+#ifdef EMUZETA80_TIMING
+    // Every machine cycle is reported by the instruction handlers
+    return cpu->run(cycles);
+#else
+    uint64_t target = cpu->clockCycles + cycles;
+    uint64_t start = cpu->instructionCount;
+
+    cpu->deadline = target;
+    while(cpu->clockCycles < target)
+        dispatch(target);
+    cpu->deadline = 0;
+
+    return cpu->instructionCount - start;
+#endif
+}
+
+/**
+ * @brief Execute the instruction at PC, or the enabled pair that starts at PC
+ *
+ * @return number of executed instructions (1 or 2)
+ */
+uint16_t Fusion::step()
+{
+#ifdef EMUZETA80_TIMING
+    cpu->execute();
+    return 1;
+#else
+    return dispatch(UINT64_MAX);
+#endif
+}
+
+/**
+ * @brief Execute the enabled pair at PC or a single instruction
+ *
+ * @param target clock cycles at the end of the run
+ * @return number of executed instructions (1 or 2)
+ */
+uint16_t Fusion::dispatch(uint64_t target)
+{
+    uint16_t address = cpu->pc.value;
+    uint8_t first = cpu->memory->fetch(address);
+
+    if(lengths[first] != 0 && !(cpu->interruptPending && cpu->iff1))
+    {
+        uint8_t second = cpu->memory->fetch((uint16_t)(address + lengths[first]));
+        uint8_t handler = handlers[first << 8 | second];
+
+        if(handler != FUSED_NONE)
+        {
+            cpu->interruptDelay = false;
+            uint16_t count = executePair(handler, first, second, target);
+            cpu->instructionCount += count;
+            return count;
+        }
+    }
+
+    cpu->execute();
+    return 1;
+}
+
+/**
+ * @brief Execute a fused pair of instructions at PC
+ *
+ * The handlers do the same as the cases of CPU::executeIndexed<INDEX_HL>.
+ * The second instruction is not executed if the first one reaches the
+ * cycle budget or writes over its opcode.
+ *
+ * @param handler handler of the pair
+ * @param first opcode of the first instruction
+ * @param second opcode of the second instruction
+ * @param target clock cycles at the end of the run
+ * @return number of executed instructions (1 or 2)
+ */
+uint16_t Fusion::executePair(uint8_t handler, uint8_t first, uint8_t second, uint64_t target)
+{
+    RAM* memory = cpu->memory;
+    RegistersBank& bank = cpu->mainBank;
+    Register& pc = cpu->pc;
+    Register& sp = cpu->sp;
+    uint64_t& clockCycles = cpu->clockCycles;
+
+    switch(handler)
+    {
+    case FUSED_LOAD_INCREMENT:
+    case FUSED_STORE_INCREMENT:
+    {
+        Register& pointer = pointerOf(cpu, first);
+
+        pc.value += 1;
+        if(handler == FUSED_LOAD_INCREMENT)
+            bank.af.bytes.H = memory->peek(pointer.value);
+        else
+            memory->poke(pointer.value, bank.af.bytes.H);
+        clockCycles += 7;
+        if(clockCycles >= target || memory->fetch(pc.value) != second)
+            return 1;
+
+        pc.value += 1;
+        pointer.value += 1;
+        clockCycles += 6;
+        break;
+    }
+
+    case FUSED_DECREMENT_BRANCH:
+    case FUSED_COMPARE_BRANCH:
+    {
+        if(handler == FUSED_DECREMENT_BRANCH)
+        {
+            // Bits 3-5: B, C, D, E, H, L, -, A
+            static Register RegistersBank::*const registers[8] = {&RegistersBank::bc, &RegistersBank::bc,
+                                                                  &RegistersBank::de, &RegistersBank::de,
+                                                                  &RegistersBank::hl, &RegistersBank::hl,
+                                                                  &RegistersBank::hl, &RegistersBank::af};
+            int index = (first >> 3) & 7;
+
+            pc.value += 1;
+            clockCycles += cpu->alu.dec8(&(bank.*registers[index]), (index & 1) == 0 || index == 7);
+        }
+        else
+        {
+            pc.value += 1;
+            clockCycles += cpu->alu.cp8(&(bank.af), true, memory->fetch(pc.value++));
+            clockCycles += 3;
+        }
+        if(clockCycles >= target)
+            return 1;
+
+        // JR NZ/Z, JP NZ/Z
+        pc.value += 1;
+        if(second < 0x40)
+            clockCycles += cpu->jr(cpu->condition((second >> 3) & 3));
+        else
+            clockCycles += cpu->jp(cpu->condition((second >> 3) & 7));
+        break;
+    }
+
+    case FUSED_PUSH_PUSH:
+    {
+        Register& source = stackRegisterOf(cpu, first);
+        pc.value += 1;
+        memory->poke(--sp.value, source.bytes.H);
+        memory->poke(--sp.value, source.bytes.L);
+        clockCycles += 11;
+        if(clockCycles >= target || memory->fetch(pc.value) != second)
+            return 1;
+
+        Register& next = stackRegisterOf(cpu, second);
+        pc.value += 1;
+        memory->poke(--sp.value, next.bytes.H);
+        memory->poke(--sp.value, next.bytes.L);
+        clockCycles += 11;
+        break;
+    }
+
+    default:
+    {
+        Register& target16 = stackRegisterOf(cpu, first);
+        pc.value += 1;
+        target16.bytes.L = memory->peek(sp.value++);
+        target16.bytes.H = memory->peek(sp.value++);
+        clockCycles += 10;
+        if(clockCycles >= target)
+            return 1;
+
+        Register& next = stackRegisterOf(cpu, second);
+        pc.value += 1;
+        next.bytes.L = memory->peek(sp.value++);
+        next.bytes.H = memory->peek(sp.value++);
+        clockCycles += 10;
+        break;
+    }
+    }
+
+    return 2;
+}
+
+} // namespace emuzeta80
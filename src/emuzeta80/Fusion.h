@@ -0,0 +1,83 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Fusion.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Fusion class to run frequent instruction pairs in one dispatch
+ *
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <cstdint>
+#include <vector>
+
+#include "CPU.h"
+
+//-------------------------------------------------------------------------
+// Class definition
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Runs a CPU executing the enabled instruction pairs with one handler
+ *
+ * The pairs are looked up by the first opcode at PC and the opcode that
+ * follows it (LD A,(HL) + INC HL, DEC B + JR NZ, CP n + JR Z, PUSH/POP
+ * chains...). Only the supported pairs can be enabled, either one by one or
+ * from the pair histogram collected by profile(). The result is the same as
+ * CPU::run: the second instruction is not executed if the first one reaches
+ * the cycle budget or overwrites its opcode, and the pairs are not fused while an interrupt can be
+ * accepted. Idle loops are not skipped (CPU::skipIdleLoops) and the timing
+ * library always runs CPU::run.
+ */
+class Fusion
+{
+public:
+    Fusion(CPU* cpu);
+
+    uint64_t profile(uint64_t cycles);
+    uint64_t getCount(uint8_t first, uint8_t second);
+    void clearProfile();
+    unsigned configure(unsigned pairs);
+    bool enable(uint8_t first, uint8_t second);
+    bool isEnabled(uint8_t first, uint8_t second);
+    void disable();
+    uint64_t run(uint64_t cycles);
+    uint16_t step();
+
+    static bool isSupported(uint8_t first, uint8_t second);
+
+protected:
+    uint16_t dispatch(uint64_t target);
+    uint16_t executePair(uint8_t handler, uint8_t first, uint8_t second, uint64_t target);
+
+    CPU* cpu;
+    std::vector<uint64_t> histogram; //< executions by pair (first << 8 | second)
+    std::vector<uint8_t> handlers;   //< handler by pair (0: not fused)
+    uint8_t lengths[256];            //< length of the first instruction of the enabled pairs (0: none)
+};
+
+} // namespace emuzeta80
@@ -0,0 +1,574 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file GdbServer.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief GdbServer class to debug guest code with GDB (remote serial protocol)
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include "GdbServer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//-------------------------------------------------------------------------
+// Class implementation
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+namespace
+{
+
+const unsigned REGISTERS = 13;     //< af, bc, de, hl, sp, pc, ix, iy, af', bc', de', hl', ir
+const uint32_t MAX_MEMORY = 0x800; //< Bytes of a memory packet (PacketSize 1000h)
+
+const char HEX[] = "0123456789abcdef";
+
+/**
+ * @brief Value of a hexadecimal digit (-1 if not a digit)
+ */
+int hexDigit(char c)
+{
+    if(c >= '0' && c <= '9')
+        return c - '0';
+    if(c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+
+    return -1;
+}
+
+/**
+ * @brief Parse a hexadecimal number of a packet from a position
+ *
+ * @param position first digit, updated to the first character after the number
+ */
+uint32_t parseHex(const std::string& packet, size_t& position)
+{
+    uint32_t value = 0;
+    while(position < packet.size() && hexDigit(packet[position]) >= 0)
+        value = (value << 4) | hexDigit(packet[position++]);
+
+    return value;
+}
+
+void appendByte(std::string& text, uint8_t value)
+{
+    text += HEX[value >> 4];
+    text += HEX[value & 0x0F];
+}
+
+// 16-bit values are little endian
+void appendWord(std::string& text, uint16_t value)
+{
+    appendByte(text, value & 0xFF);
+    appendByte(text, value >> 8);
+}
+
+bool parseWord(const std::string& packet, size_t position, uint16_t& value)
+{
+    if(position + 4 > packet.size())
+        return false;
+
+    int digits[4];
+    for(int i = 0; i < 4; i++)
+    {
+        digits[i] = hexDigit(packet[position + i]);
+        if(digits[i] < 0)
+            return false;
+    }
+    value = (digits[0] << 4 | digits[1]) | (digits[2] << 4 | digits[3]) << 8;
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Construct a new GdbServer instance (not listening)
+ *
+ * @param cpu CPU to debug
+ */
+GdbServer::GdbServer(CPU* cpu) : debugger(cpu)
+{
+    this->cpu = cpu;
+    server = -1;
+    client = -1;
+    breakRequest = false;
+}
+
+/**
+ * @brief Close the sockets (and remove the Unix socket)
+ */
+GdbServer::~GdbServer()
+{
+    if(client >= 0)
+        close(client);
+    if(server >= 0)
+        close(server);
+    if(!path.empty())
+        unlink(path.c_str());
+}
+
+/**
+ * @brief Listen on a TCP port of localhost (127.0.0.1)
+ *
+ * @param port TCP port
+ * @return false if the socket could not be created
+ */
+bool GdbServer::listen(uint16_t port)
+{
+    server = socket(AF_INET, SOCK_STREAM, 0);
+    if(server < 0)
+        return false;
+
+    int reuse = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if(bind(server, (sockaddr*)&address, sizeof(address)) < 0 || ::listen(server, 1) < 0)
+    {
+        close(server);
+        server = -1;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Listen on a Unix socket
+ *
+ * @param path path of the socket (an existing file is replaced)
+ * @return false if the socket could not be created
+ */
+bool GdbServer::listen(const char* path)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(std::strlen(path) >= sizeof(address.sun_path))
+        return false;
+    std::strcpy(address.sun_path, path);
+
+    server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(server < 0)
+        return false;
+
+    unlink(path);
+    if(bind(server, (sockaddr*)&address, sizeof(address)) < 0 || ::listen(server, 1) < 0)
+    {
+        close(server);
+        server = -1;
+        return false;
+    }
+    this->path = path;
+
+    return true;
+}
+
+/**
+ * @brief Accept a client and process its packets until it detaches, kills or disconnects
+ *
+ * @return false if there is no listening socket or the client could not be accepted
+ */
+bool GdbServer::serve()
+{
+    if(server < 0)
+        return false;
+
+    client = accept(server, nullptr, nullptr);
+    if(client < 0)
+        return false;
+
+    std::string packet;
+    while(receive(packet))
+    {
+        std::string reply = handle(packet);
+        if(!send(reply))
+            break;
+        if(packet == "D" || packet == "k")
+            break;
+    }
+
+    close(client);
+    client = -1;
+    return true;
+}
+
+/**
+ * @brief Process one packet (without the framing) and build the reply
+ *
+ * @param packet command and arguments
+ * @return reply (empty if the command is not supported)
+ */
+std::string GdbServer::handle(const std::string& packet)
+{
+    if(packet.empty())
+        return "";
+
+    std::string reply;
+    size_t position = 1;
+    switch(packet[0])
+    {
+    case '?':
+        return stopReply();
+
+    case 'g':
+        for(unsigned index = 0; index < REGISTERS; index++)
+            appendWord(reply, getRegister(index));
+        return reply;
+
+    case 'G':
+        for(unsigned index = 0; index < REGISTERS; index++)
+        {
+            uint16_t value;
+            if(!parseWord(packet, 1 + index * 4, value))
+                return "E01";
+            setRegister(index, value);
+        }
+        return "OK";
+
+    case 'p':
+    {
+        unsigned index = parseHex(packet, position);
+        if(index >= REGISTERS)
+            return "E01";
+        appendWord(reply, getRegister(index));
+        return reply;
+    }
+
+    case 'P':
+    {
+        unsigned index = parseHex(packet, position);
+        uint16_t value;
+        if(index >= REGISTERS || position >= packet.size() || packet[position] != '=' ||
+           !parseWord(packet, position + 1, value))
+            return "E01";
+        setRegister(index, value);
+        return "OK";
+    }
+
+    case 'm':
+    {
+        uint32_t address = parseHex(packet, position);
+        if(position >= packet.size() || packet[position++] != ',')
+            return "E01";
+        uint32_t length = parseHex(packet, position);
+        if(length > MAX_MEMORY)
+            length = MAX_MEMORY;
+        for(uint32_t i = 0; i < length; i++)
+            appendByte(reply, cpu->memory->peek((address + i) & 0xFFFF));
+        return reply;
+    }
+
+    case 'M':
+    {
+        uint32_t address = parseHex(packet, position);
+        if(position >= packet.size() || packet[position++] != ',')
+            return "E01";
+        uint32_t length = parseHex(packet, position);
+        if(position >= packet.size() || packet[position++] != ':' || packet.size() - position < length * 2)
+            return "E01";
+        for(uint32_t i = 0; i < length * 2; i++)
+        {
+            if(hexDigit(packet[position + i]) < 0)
+                return "E01";
+        }
+
+        // load() also writes the ROM regions
+        for(uint32_t i = 0; i < length; i++)
+        {
+            uint8_t value = hexDigit(packet[position + i * 2]) << 4 | hexDigit(packet[position + i * 2 + 1]);
+            cpu->memory->load((address + i) & 0xFFFF, &value, 1);
+        }
+        return "OK";
+    }
+
+    case 'c':
+    case 's':
+        if(position < packet.size())
+            cpu->pc.value = parseHex(packet, position);
+        return resume(packet[0] == 's');
+
+    case 'Z':
+    case 'z':
+    {
+        char type = packet.size() > 1 ? packet[1] : 0;
+        position = 2;
+        if(position >= packet.size() || packet[position++] != ',')
+            return "E01";
+        uint32_t address = parseHex(packet, position);
+        if(position >= packet.size() || packet[position++] != ',')
+            return "E01";
+        uint32_t length = parseHex(packet, position);
+        bool insert = packet[0] == 'Z';
+
+        if(type == '0' || type == '1')
+        {
+            if(insert)
+                debugger.addBreakpoint(address);
+            else
+                debugger.removeBreakpoint(address);
+            return "OK";
+        }
+        if(type >= '2' && type <= '4')
+        {
+            if(insert)
+                debugger.addWatchpoint(address, length, type != '2', type != '3');
+            else
+                debugger.removeWatchpoint(address, length);
+            return "OK";
+        }
+        return "";
+    }
+
+    case 'H':
+    case 'D':
+        return "OK";
+
+    case 'k':
+        return "";
+
+    case 'q':
+        if(packet.compare(0, 10, "qSupported") == 0)
+            return "PacketSize=1000";
+        if(packet == "qAttached")
+            return "1";
+        if(packet == "qC")
+            return "QC1";
+        if(packet == "qfThreadInfo")
+            return "m1";
+        if(packet == "qsThreadInfo")
+            return "l";
+        return "";
+
+    default:
+        return "";
+    }
+}
+
+/**
+ * @brief Receive a packet from the client (acknowledged)
+ *
+ * Acknowledgements and break requests outside a packet are skipped.
+ *
+ * @return false if the client disconnected
+ */
+bool GdbServer::receive(std::string& packet)
+{
+    char c;
+    while(true)
+    {
+        do
+        {
+            if(read(client, &c, 1) != 1)
+                return false;
+        }
+        while(c != '$');
+
+        packet.clear();
+        while(true)
+        {
+            if(read(client, &c, 1) != 1)
+                return false;
+            if(c == '#')
+                break;
+            packet += c;
+        }
+
+        char checksum[2];
+        if(read(client, &checksum[0], 1) != 1 || read(client, &checksum[1], 1) != 1)
+            return false;
+
+        uint8_t sum = 0;
+        for(char byte : packet)
+            sum += (uint8_t)byte;
+
+        bool valid = hexDigit(checksum[0]) << 4 == (sum & 0xF0) && hexDigit(checksum[1]) == (sum & 0x0F);
+        if(::send(client, valid ? "+" : "-", 1, MSG_NOSIGNAL) != 1)
+            return false;
+        if(valid)
+            return true;
+    }
+}
+
+/**
+ * @brief Send a packet to the client (the acknowledgement is skipped by receive)
+ *
+ * @return false if the client disconnected
+ */
+bool GdbServer::send(const std::string& packet)
+{
+    uint8_t sum = 0;
+    for(char byte : packet)
+        sum += (uint8_t)byte;
+
+    std::string frame = "$" + packet + "#";
+    appendByte(frame, sum);
+
+    // No SIGPIPE if the client disconnected
+    return ::send(client, frame.data(), frame.size(), MSG_NOSIGNAL) == (ssize_t)frame.size();
+}
+
+/**
+ * @brief Check (without waiting) if the client sent a break request (Ctrl-C)
+ */
+bool GdbServer::interrupted()
+{
+    if(client < 0)
+        return false;
+
+    pollfd descriptor = {client, POLLIN, 0};
+    while(poll(&descriptor, 1, 0) > 0 && (descriptor.revents & POLLIN))
+    {
+        char c;
+        if(read(client, &c, 1) != 1)
+            return true;
+        if(c == 0x03)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Continue or step the CPU and build the stop reply
+ */
+std::string GdbServer::resume(bool step)
+{
+    breakRequest = false;
+    if(step)
+    {
+        debugger.step();
+        return stopReply();
+    }
+
+    while(true)
+    {
+        debugger.run(slice);
+        if(debugger.getStopReason() != Debugger::STOP_NONE)
+            break;
+        if(interrupted())
+        {
+            breakRequest = true;
+            break;
+        }
+    }
+
+    return stopReply();
+}
+
+/**
+ * @brief Reply with the reason of the last stop (SIGTRAP, or SIGINT after a break request)
+ */
+std::string GdbServer::stopReply()
+{
+    if(breakRequest)
+        return "S02";
+
+    std::string reply = "T05";
+    switch(debugger.getStopReason())
+    {
+    case Debugger::STOP_READ:
+        reply += "rwatch:";
+        break;
+    case Debugger::STOP_WRITE:
+        reply += "watch:";
+        break;
+    default:
+        return "S05";
+    }
+
+    uint16_t address = debugger.getStopAddress();
+    appendByte(reply, address >> 8);
+    appendByte(reply, address & 0xFF);
+    return reply + ";";
+}
+
+/**
+ * @brief Value of a register in the order of GDB
+ */
+uint16_t GdbServer::getRegister(unsigned index)
+{
+    switch(index)
+    {
+    case 0: return cpu->mainBank.af.value;
+    case 1: return cpu->mainBank.bc.value;
+    case 2: return cpu->mainBank.de.value;
+    case 3: return cpu->mainBank.hl.value;
+    case 4: return cpu->sp.value;
+    case 5: return cpu->pc.value;
+    case 6: return cpu->iX.value;
+    case 7: return cpu->iY.value;
+    case 8: return cpu->alternateBank.af.value;
+    case 9: return cpu->alternateBank.bc.value;
+    case 10: return cpu->alternateBank.de.value;
+    case 11: return cpu->alternateBank.hl.value;
+    default: return cpu->i << 8 | cpu->getr();
+    }
+}
+
+/**
+ * @brief Set a register in the order of GDB
+ */
+void GdbServer::setRegister(unsigned index, uint16_t value)
+{
+    switch(index)
+    {
+    case 0: cpu->mainBank.af.value = value; break;
+    case 1: cpu->mainBank.bc.value = value; break;
+    case 2: cpu->mainBank.de.value = value; break;
+    case 3: cpu->mainBank.hl.value = value; break;
+    case 4: cpu->sp.value = value; break;
+    case 5: cpu->pc.value = value; break;
+    case 6: cpu->iX.value = value; break;
+    case 7: cpu->iY.value = value; break;
+    case 8: cpu->alternateBank.af.value = value; break;
+    case 9: cpu->alternateBank.bc.value = value; break;
+    case 10: cpu->alternateBank.de.value = value; break;
+    case 11: cpu->alternateBank.hl.value = value; break;
+    default:
+        cpu->i = value >> 8;
+        cpu->setr(value & 0xFF);
+        break;
+    }
+}
+
+} // namespace emuzeta80
@@ -0,0 +1,89 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file GdbServer.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief GdbServer class to debug guest code with GDB (remote serial protocol)
+ *
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <cstdint>
+#include <string>
+
+#include "CPU.h"
+#include "Debugger.h"
+
+//-------------------------------------------------------------------------
+// Class definition
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief GDB remote serial protocol server for a CPU
+ *
+ * Listens on a TCP port of localhost or on a Unix socket and serves one
+ * client at a time (target remote :port or target remote /path in GDB
+ * with set architecture z80). Registers are af, bc, de, hl, sp, pc, ix,
+ * iy, af', bc', de', hl' and ir (16 bits each), memory is accessed
+ * through the RAM (writes also patch ROM regions), breakpoints and
+ * watchpoints (Z0-Z4) are the ones of a Debugger.
+ *
+ * Continue runs Debugger::run (the interpreter loop of CPU::run) in slices
+ * of clock cycles and only checks for a break request (Ctrl-C) between
+ * them, so the guest runs at full speed until it stops.
+ */
+class GdbServer
+{
+public:
+    GdbServer(CPU* cpu);
+    ~GdbServer();
+
+    bool listen(uint16_t port);
+    bool listen(const char* path);
+    bool serve();
+    std::string handle(const std::string& packet);
+
+    uint64_t slice = 1000000; //< Clock cycles run between the checks of a break request
+
+protected:
+    bool receive(std::string& packet);
+    bool send(const std::string& packet);
+    bool interrupted();
+    std::string resume(bool step);
+    std::string stopReply();
+    uint16_t getRegister(unsigned index);
+    void setRegister(unsigned index, uint16_t value);
+
+    CPU* cpu;
+    Debugger debugger;
+    int server;        //< listening socket (-1: none)
+    int client;        //< connected client (-1: none)
+    std::string path;  //< Unix socket to remove when closed
+    bool breakRequest; //< Ctrl-C received while running
+};
+
+} // namespace emuzeta80
@@ -0,0 +1,736 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Lockstep.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Lockstep class to run several CPU instances that execute the same code
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include "Lockstep.h"
+#include "CPUImpl.h"
+
+//-------------------------------------------------------------------------
+// Lane operations
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+namespace
+{
+
+inline uint8_t flag(uint8_t f, Flag flag, bool value)
+{
+    return value ? f | flag : f & ~flag;
+}
+
+// The operations below compute exactly the same results and flags as the
+// corresponding ALU methods, so lanes can move between the lockstep group
+// and their scalar CPU at any instruction.
+
+/**
+ * @brief ADD/ADC, ALU::add8 with a register (Signed = false) or a value (Signed = true)
+ */
+template<bool Carry, bool Signed>
+struct Add
+{
+    static uint8_t apply(uint8_t a, uint8_t value, uint8_t& f)
+    {
+        int carry = (Carry && (f & FLAG_C)) ? 1 : 0;
+        int result = Signed ? (char)a + (char)value + carry : a + value + carry;
+        if(!Signed)
+            result = (uint16_t)result;
+
+        f = flag(f, FLAG_N, false);
+        f = flag(f, FLAG_Z, result == 0);
+        f = flag(f, FLAG_S, Signed ? result < 0 : (result & 0x80) != 0);
+        f = flag(f, FLAG_C, result > 0xFF);
+        f = flag(f, FLAG_H, (a & 0x0F) + (value & 0x0F) > 0x0F);
+        f = flag(f, FLAG_P, result > 127 || result < -128);
+
+        return (uint8_t)result;
+    }
+};
+
+/**
+ * @brief SUB/SBC/CP, ALU::sub8 and ALU::cp8
+ */
+template<bool Carry, bool Store>
+struct Sub
+{
+    static uint8_t apply(uint8_t a, uint8_t value, uint8_t& f)
+    {
+        int carry = (Carry && (f & FLAG_C)) ? 1 : 0;
+        int16_t result = (char)a - (char)value - carry;
+
+        f = flag(f, FLAG_N, true);
+        f = flag(f, FLAG_Z, result == 0);
+        f = flag(f, FLAG_S, result < 0);
+        f = flag(f, FLAG_C, (result & 0xFF00) > 0);
+        f = flag(f, FLAG_H, (a & 0x0F) + (value & 0x0F) > 0x0F);
+        f = flag(f, FLAG_P, result > 127 || result < -128);
+
+        return Store ? (uint8_t)result : a;
+    }
+};
+
+/**
+ * @brief AND/OR/XOR, ALU::and8, ALU::or8 and ALU::xor8
+ */
+template<int Operation>
+struct Logic
+{
+    static uint8_t apply(uint8_t a, uint8_t value, uint8_t& f)
+    {
+        uint8_t result = Operation == 0 ? a & value : (Operation == 1 ? a | value : a ^ value);
+
+        f = flag(f, FLAG_N, false);
+        f = flag(f, FLAG_Z, result == 0);
+        f = flag(f, FLAG_S, (result & 0x80) > 0);
+        f = flag(f, FLAG_C, false);
+        f = flag(f, FLAG_H, Operation == 0);
+        f = flag(f, FLAG_P, true);
+
+        return result;
+    }
+};
+
+typedef Logic<0> And;
+typedef Logic<1> Or;
+typedef Logic<2> Xor;
+
+} // namespace
+
+//-------------------------------------------------------------------------
+// Class implementation
+//-------------------------------------------------------------------------
+
+/**
+ * @brief Construct a new Lockstep instance
+ *
+ * Lanes with the same PC and clock cycles as the majority of the lanes
+ * form the lockstep group. The rest of the lanes run on their scalar CPU.
+ *
+ * @param cpus array with the CPU of every lane
+ */
+template<unsigned Lanes>
+Lockstep<Lanes>::Lockstep(CPU* const* cpus)
+{
+    for(unsigned lane = 0; lane < Lanes; lane++)
+    {
+        this->cpus[lane] = cpus[lane];
+        grouped[lane] = true;
+    }
+
+    regroup();
+}
+
+/**
+ * @brief Get the number of lanes running in lockstep
+ *
+ * @return number of grouped lanes
+ */
+template<unsigned Lanes>
+unsigned Lockstep<Lanes>::getGroupedLanes()
+{
+    unsigned count = 0;
+    for(unsigned lane = 0; lane < Lanes; lane++)
+        count += grouped[lane];
+
+    return count;
+}
+
+/**
+ * @brief Get the number of instructions executed for all the lanes at once
+ */
+template<unsigned Lanes>
+uint64_t Lockstep<Lanes>::getVectorInstructions()
+{
+    return vectorInstructions;
+}
+
+/**
+ * @brief Get the number of instructions of the group executed by the scalar CPUs
+ */
+template<unsigned Lanes>
+uint64_t Lockstep<Lanes>::getScalarInstructions()
+{
+    return scalarInstructions;
+}
+
+/**
+ * @brief Execute instructions on all the lanes until a number of clock cycles is consumed
+ *
+ * @param cycles budget of clock cycles of every lane
+ * @return number of instructions executed by the lockstep group
+ */
+template<unsigned Lanes>
+uint64_t Lockstep<Lanes>::run(uint64_t cycles)
+{
+    uint64_t targets[Lanes];
+    for(unsigned lane = 0; lane < Lanes; lane++)
+        targets[lane] = cpus[lane]->clockCycles + cycles;
+
+    uint64_t instructions = 0;
+    if(getGroupedLanes() > 0)
+    {
+        uint64_t target = targets[leader];
+
+        gather();
+        while(clockCycles < target)
+        {
+            if(!executeVector())
+            {
+                executeScalar();
+                if(getGroupedLanes() == 0)
+                    break;
+            }
+            instructions++;
+        }
+        scatter();
+    }
+
+    // Lanes out of the group finish their budget on the scalar CPU
+    for(unsigned lane = 0; lane < Lanes; lane++)
+    {
+        if(!grouped[lane] && cpus[lane]->clockCycles < targets[lane])
+            cpus[lane]->run(targets[lane] - cpus[lane]->clockCycles);
+    }
+
+    return instructions;
+}
+
+/**
+ * @brief Keep in the group only the lanes with the PC and clock cycles of the majority
+ */
+template<unsigned Lanes>
+void Lockstep<Lanes>::regroup()
+{
+    unsigned best = Lanes;
+    unsigned bestCount = 0;
+
+    for(unsigned lane = 0; lane < Lanes; lane++)
+    {
+        if(!grouped[lane])
+            continue;
+
+        unsigned count = 0;
+        for(unsigned other = lane; other < Lanes; other++)
+        {
+            count += grouped[other] && cpus[other]->pc.value == cpus[lane]->pc.value &&
+                     cpus[other]->clockCycles == cpus[lane]->clockCycles;
+        }
+
+        if(count > bestCount)
+        {
+            best = lane;
+            bestCount = count;
+        }
+    }
+
+    for(unsigned lane = 0; lane < Lanes; lane++)
+    {
+        grouped[lane] = grouped[lane] && best < Lanes && cpus[lane]->pc.value == cpus[best]->pc.value &&
+                        cpus[lane]->clockCycles == cpus[best]->clockCycles;
+    }
+
+    leader = best;
+}
+
+/**
+ * @brief Copy the registers of the grouped lanes from their CPU into the arrays
+ */
+template<unsigned Lanes>
+void Lockstep<Lanes>::gather()
+{
+    pc = cpus[leader]->pc.value;
+    clockCycles = cpus[leader]->clockCycles;
+    interrupts = false;
+    gatheredInstructions = vectorInstructions;
+
+    for(unsigned lane = 0; lane < Lanes; lane++)
+    {
+        Snapshot snapshot;
+        cpus[lane]->save(snapshot);
+
+        if(grouped[lane])
+            interrupts = interrupts || (snapshot.iff1 && (cpus[lane]->interruptPending || snapshot.interruptDelay));
+
+        a[lane] = snapshot.mainBank.af.bytes.H;
+        f[lane] = snapshot.mainBank.af.bytes.L;
+        b[lane] = snapshot.mainBank.bc.bytes.H;
+        c[lane] = snapshot.mainBank.bc.bytes.L;
+        d[lane] = snapshot.mainBank.de.bytes.H;
+        e[lane] = snapshot.mainBank.de.bytes.L;
+        h[lane] = snapshot.mainBank.hl.bytes.H;
+        l[lane] = snapshot.mainBank.hl.bytes.L;
+        sp[lane] = snapshot.sp.value;
+    }
+}
+
+/**
+ * @brief Copy the registers of the grouped lanes from the arrays into their CPU
+ */
+template<unsigned Lanes>
+void Lockstep<Lanes>::scatter()
+{
+    for(unsigned lane = 0; lane < Lanes; lane++)
+    {
+        if(!grouped[lane])
+            continue;
+
+        Snapshot snapshot;
+        cpus[lane]->save(snapshot);
+
+        snapshot.mainBank.af.bytes.H = a[lane];
+        snapshot.mainBank.af.bytes.L = f[lane];
+        snapshot.mainBank.bc.bytes.H = b[lane];
+        snapshot.mainBank.bc.bytes.L = c[lane];
+        snapshot.mainBank.de.bytes.H = d[lane];
+        snapshot.mainBank.de.bytes.L = e[lane];
+        snapshot.mainBank.hl.bytes.H = h[lane];
+        snapshot.mainBank.hl.bytes.L = l[lane];
+        snapshot.sp.value = sp[lane];
+        snapshot.pc.value = pc;
+        snapshot.clockCycles = clockCycles;
+
+        // One M1 cycle per vector instruction (they have no prefix)
+        uint8_t r = snapshot.r + (uint8_t)(vectorInstructions - gatheredInstructions);
+        snapshot.r = (snapshot.r & 0x80) | (r & 0x7F);
+
+        cpus[lane]->restore(snapshot);
+    }
+}
+
+/**
+ * @brief Execute one instruction of the group on the scalar CPU of every lane
+ */
+template<unsigned Lanes>
+void Lockstep<Lanes>::executeScalar()
+{
+    scatter();
+    for(unsigned lane = 0; lane < Lanes; lane++)
+    {
+        if(grouped[lane])
+            cpus[lane]->execute();
+    }
+    scalarInstructions++;
+
+    regroup();
+    if(leader < Lanes)
+        gather();
+}
+
+/**
+ * @brief Read an instruction byte that must be the same for all the grouped lanes
+ *
+ * @param address memory address
+ * @param value byte read from memory
+ * @return false if the byte differs between lanes
+ */
+template<unsigned Lanes>
+bool Lockstep<Lanes>::fetch(uint16_t address, uint8_t& value)
+{
+    value = cpus[leader]->memory->fetch(address);
+    for(unsigned lane = 0; lane < Lanes; lane++)
+    {
+        if(grouped[lane] && cpus[lane]->memory->fetch(address) != value)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get the array of an 8-bit register by its index in the opcode (B, C, D, E, H, L, (HL), A)
+ *
+ * @return array of the register or nullptr for (HL)
+ */
+template<unsigned Lanes>
+uint8_t* Lockstep<Lanes>::reg8(unsigned index)
+{
+    uint8_t* registers[] = {b, c, d, e, h, l, nullptr, a};
+    return registers[index];
+}
+
+/**
+ * @brief Read the byte pointed by HL of every grouped lane
+ *
+ * Lanes out of the group keep their value (their memory is not accessed).
+ *
+ * @param values array receiving the bytes
+ */
+template<unsigned Lanes>
+void Lockstep<Lanes>::readHL(uint8_t* values)
+{
+    for(unsigned lane = 0; lane < Lanes; lane++)
+    {
+        if(grouped[lane])
+            values[lane] = cpus[lane]->memory->peek((h[lane] << 8) | l[lane]);
+    }
+}
+
+/**
+ * @brief Apply an 8-bit ALU operation to A with an operand per lane
+ */
+template<unsigned Lanes>
+template<class Op>
+void Lockstep<Lanes>::alu8(const uint8_t* operand)
+{
+    for(unsigned lane = 0; lane < Lanes; lane++)
+        a[lane] = Op::apply(a[lane], operand[lane], f[lane]);
+}
+
+/**
+ * @brief Apply an 8-bit ALU operation to A with the same operand for all lanes
+ */
+template<unsigned Lanes>
+template<class Op>
+void Lockstep<Lanes>::alu8(uint8_t operand)
+{
+    for(unsigned lane = 0; lane < Lanes; lane++)
+        a[lane] = Op::apply(a[lane], operand, f[lane]);
+}
+
+/**
+ * @brief Increase or decrease a 16-bit register stored as two 8-bit arrays
+ */
+template<unsigned Lanes>
+void Lockstep<Lanes>::incdec16(uint8_t* high, uint8_t* low, int delta)
+{
+    for(unsigned lane = 0; lane < Lanes; lane++)
+    {
+        uint16_t value = ((high[lane] << 8) | low[lane]) + delta;
+        high[lane] = value >> 8;
+        low[lane] = (uint8_t)value;
+    }
+}
+
+/**
+ * @brief Execute one instruction for all the grouped lanes at once
+ *
+ * @return false if the instruction is not supported in lockstep (PC is not modified)
+ */
+template<unsigned Lanes>
+bool Lockstep<Lanes>::executeVector()
+{
+#ifdef EMUZETA80_TIMING
+    // Machine cycles are reported by the scalar CPUs
+    return false;
+#endif
+
+    uint8_t opcode;
+    if(interrupts || !fetch(pc, opcode))
+        return false;
+
+    // LD r, r' / LD r, (HL) / LD (HL), r
+    if(opcode >= 0x40 && opcode < 0x80 && opcode != 0x76)
+    {
+        uint8_t* target = reg8((opcode >> 3) & 0x07);
+        uint8_t* source = reg8(opcode & 0x07);
+
+        if(source == nullptr)
+        {
+            readHL(target);
+            clockCycles += 7;
+        }
+        else if(target == nullptr)
+        {
+            for(unsigned lane = 0; lane < Lanes; lane++)
+            {
+                if(grouped[lane])
+                    cpus[lane]->memory->poke((h[lane] << 8) | l[lane], source[lane]);
+            }
+            clockCycles += 7;
+        }
+        else
+        {
+            for(unsigned lane = 0; lane < Lanes; lane++)
+                target[lane] = source[lane];
+            clockCycles += 4;
+        }
+
+        pc++;
+        vectorInstructions++;
+        return true;
+    }
+
+    // ADD/ADC/SUB/SBC/AND/XOR/OR/CP A, r / (HL)
+    if(opcode >= 0x80 && opcode < 0xC0)
+    {
+        const uint8_t* source = reg8(opcode & 0x07);
+        bool memory = source == nullptr;
+        if(memory)
+        {
+            readHL(operand);
+            source = operand;
+        }
+
+        switch((opcode >> 3) & 0x07)
+        {
+        case 0: memory ? alu8<Add<false, true>>(source) : alu8<Add<false, false>>(source); break;
+        case 1: memory ? alu8<Add<true, true>>(source) : alu8<Add<true, false>>(source); break;
+        case 2: alu8<Sub<false, true>>(source); break;
+        case 3: alu8<Sub<true, true>>(source); break;
+        case 4: alu8<And>(source); break;
+        case 5: alu8<Xor>(source); break;
+        case 6: alu8<Or>(source); break;
+        default: alu8<Sub<false, false>>(source); break;
+        }
+
+        clockCycles += memory ? 7 : 4;
+        pc++;
+        vectorInstructions++;
+        return true;
+    }
+
+    uint8_t low, high;
+
+    switch(opcode)
+    {
+    case 0x00:
+    {
+        // NOP
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x01:
+    case 0x11:
+    case 0x21:
+    case 0x31:
+    {
+        // LD rr, **
+        if(!fetch(pc + 1, low) || !fetch(pc + 2, high))
+            return false;
+
+        for(unsigned lane = 0; lane < Lanes; lane++)
+        {
+            switch(opcode)
+            {
+            case 0x01: b[lane] = high; c[lane] = low; break;
+            case 0x11: d[lane] = high; e[lane] = low; break;
+            case 0x21: h[lane] = high; l[lane] = low; break;
+            default: sp[lane] = (high << 8) | low; break;
+            }
+        }
+
+        pc += 2;
+        clockCycles += 10;
+        break;
+    }
+
+    case 0x03: incdec16(b, c, 1); clockCycles += 6; break;  // INC BC
+    case 0x13: incdec16(d, e, 1); clockCycles += 6; break;  // INC DE
+    case 0x23: incdec16(h, l, 1); clockCycles += 6; break;  // INC HL
+    case 0x0B: incdec16(b, c, -1); clockCycles += 6; break; // DEC BC
+    case 0x1B: incdec16(d, e, -1); clockCycles += 6; break; // DEC DE
+    case 0x2B: incdec16(h, l, -1); clockCycles += 6; break; // DEC HL
+
+    case 0x33:
+    case 0x3B:
+    {
+        // INC SP / DEC SP
+        int delta = opcode == 0x33 ? 1 : -1;
+        for(unsigned lane = 0; lane < Lanes; lane++)
+            sp[lane] += delta;
+
+        clockCycles += 6;
+        break;
+    }
+
+    case 0x04:
+    case 0x0C:
+    case 0x14:
+    case 0x1C:
+    case 0x24:
+    case 0x2C:
+    case 0x3C:
+    {
+        // INC r (ALU::inc8)
+        uint8_t* target = reg8((opcode >> 3) & 0x07);
+        for(unsigned lane = 0; lane < Lanes; lane++)
+        {
+            uint8_t value = target[lane];
+            uint8_t result = value + 1;
+            target[lane] = result;
+
+            uint8_t flags = f[lane];
+            flags = flag(flags, FLAG_N, false);
+            flags = flag(flags, FLAG_P, value == 0x7F);
+            flags = flag(flags, FLAG_H, value == 0x0F);
+            flags = flag(flags, FLAG_Z, result == 0);
+            flags = flag(flags, FLAG_S, result == 0x80);
+            f[lane] = flags;
+        }
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x05:
+    case 0x0D:
+    case 0x15:
+    case 0x1D:
+    case 0x25:
+    case 0x2D:
+    case 0x3D:
+    {
+        // DEC r (ALU::dec8)
+        uint8_t* target = reg8((opcode >> 3) & 0x07);
+        for(unsigned lane = 0; lane < Lanes; lane++)
+        {
+            uint8_t value = target[lane];
+            uint8_t result = value - 1;
+            target[lane] = result;
+
+            uint8_t flags = f[lane];
+            flags = flag(flags, FLAG_N, true);
+            flags = flag(flags, FLAG_P, value == 0x80);
+            flags = flag(flags, FLAG_H, result == 0x0F);
+            flags = flag(flags, FLAG_Z, result == 0);
+            flags = flag(flags, FLAG_S, result == 0x7F);
+            f[lane] = flags;
+        }
+
+        clockCycles += 4;
+        break;
+    }
+
+    case 0x06:
+    case 0x0E:
+    case 0x16:
+    case 0x1E:
+    case 0x26:
+    case 0x2E:
+    case 0x3E:
+    {
+        // LD r, *
+        if(!fetch(pc + 1, low))
+            return false;
+
+        uint8_t* target = reg8((opcode >> 3) & 0x07);
+        for(unsigned lane = 0; lane < Lanes; lane++)
+            target[lane] = low;
+
+        pc++;
+        clockCycles += 7;
+        break;
+    }
+
+    case 0x36:
+    {
+        // LD (HL), *
+        if(!fetch(pc + 1, low))
+            return false;
+
+        for(unsigned lane = 0; lane < Lanes; lane++)
+        {
+            if(grouped[lane])
+                cpus[lane]->memory->poke((h[lane] << 8) | l[lane], low);
+        }
+
+        pc++;
+        clockCycles += 10;
+        break;
+    }
+
+    case 0xC6:
+    case 0xCE:
+    case 0xD6:
+    case 0xDE:
+    case 0xE6:
+    case 0xFE:
+    {
+        // ADD/ADC/SUB/SBC/AND/CP A, *
+        if(!fetch(pc + 1, low))
+            return false;
+
+        switch(opcode)
+        {
+        case 0xC6: alu8<Add<false, true>>(low); break;
+        case 0xCE: alu8<Add<true, true>>(low); break;
+        case 0xD6: alu8<Sub<false, true>>(low); break;
+        case 0xDE: alu8<Sub<true, true>>(low); break;
+        case 0xE6: alu8<And>(low); break;
+        default: alu8<Sub<false, false>>(low); break;
+        }
+
+        pc++;
+        clockCycles += 7;
+        break;
+    }
+
+    case 0xC3:
+    {
+        // JP **
+        if(!fetch(pc + 1, low) || !fetch(pc + 2, high))
+            return false;
+
+        pc = (high << 8) | low;
+        clockCycles += 10;
+        vectorInstructions++;
+        return true;
+    }
+
+    case 0xC2:
+    case 0xCA:
+    case 0xD2:
+    case 0xDA:
+    case 0xE2:
+    case 0xEA:
+    case 0xF2:
+    case 0xFA:
+    {
+        // JP cc, ** (only if the condition is the same for all the lanes)
+        const bool* conditions = detail::conditions.taken[(opcode >> 3) & 0x07];
+        bool taken = conditions[f[leader]];
+        for(unsigned lane = 0; lane < Lanes; lane++)
+        {
+            if(grouped[lane] && conditions[f[lane]] != taken)
+                return false;
+        }
+
+        if(!fetch(pc + 1, low) || !fetch(pc + 2, high))
+            return false;
+
+        pc = taken ? (high << 8) | low : pc + 3;
+        clockCycles += 10;
+        vectorInstructions++;
+        return true;
+    }
+
+    default:
+        return false;
+    }
+
+    pc++;
+    vectorInstructions++;
+    return true;
+}
+
+template class Lockstep<8>;
+template class Lockstep<16>;
+
+} // namespace emuzeta80
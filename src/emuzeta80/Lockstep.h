@@ -0,0 +1,109 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Lockstep.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Lockstep class to run several CPU instances that execute the same code
+ *
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <cstdint>
+
+#include "CPU.h"
+
+//-------------------------------------------------------------------------
+// Class definition
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Runs a group of CPU instances in lockstep
+ *
+ * The A, F, B, C, D, E, H, L and SP registers of the instances are kept in a
+ * structure of arrays (one array element per lane) while the instances share
+ * the same PC and clock cycles. Register loads, 8-bit ALU operations, 16-bit
+ * increments and jumps are executed for all lanes at once with loops over the
+ * arrays that the compiler vectorizes (build with -mavx2 or -mavx512bw to use
+ * the wider registers).
+ *
+ * Any other instruction is executed by the scalar CPU of every lane. Lanes
+ * that end up with a different PC or cycle count than the majority leave the
+ * group and run on their scalar CPU until the end of the budget.
+ *
+ * The memory of every lane is the memory of its CPU. Instruction bytes are
+ * compared across lanes, so lanes whose code differs are executed by the
+ * scalar CPUs.
+ *
+ * While any grouped lane has interrupts enabled and one pending (or is in the
+ * instruction that follows EI) the group is executed by the scalar CPUs, which
+ * accept the interrupts.
+ */
+template<unsigned Lanes>
+class Lockstep
+{
+public:
+    Lockstep(CPU* const* cpus);
+
+    uint64_t run(uint64_t cycles);
+    unsigned getGroupedLanes();
+    uint64_t getVectorInstructions();
+    uint64_t getScalarInstructions();
+
+protected:
+    void regroup();
+    void gather();
+    void scatter();
+    bool fetch(uint16_t address, uint8_t& value);
+    bool executeVector();
+    void executeScalar();
+
+    uint8_t* reg8(unsigned index);
+    void readHL(uint8_t* values);
+    template<class Op> void alu8(const uint8_t* operand);
+    template<class Op> void alu8(uint8_t operand);
+    void incdec16(uint8_t* high, uint8_t* low, int delta);
+
+    CPU* cpus[Lanes];
+    bool grouped[Lanes];
+    unsigned leader;
+    uint64_t vectorInstructions = 0;
+    uint64_t scalarInstructions = 0;
+    uint64_t gatheredInstructions = 0; //< vectorInstructions at the last gather (R of the lanes)
+
+    // State of the grouped lanes
+    uint16_t pc;
+    uint64_t clockCycles;
+    bool interrupts;
+    uint8_t a[Lanes], f[Lanes];
+    uint8_t b[Lanes], c[Lanes];
+    uint8_t d[Lanes], e[Lanes];
+    uint8_t h[Lanes], l[Lanes];
+    uint16_t sp[Lanes];
+    uint8_t operand[Lanes] = {};
+};
+
+} // namespace emuzeta80
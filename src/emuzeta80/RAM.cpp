@@ -29,6 +29,7 @@
 //-------------------------------------------------------------------------
 
 #include "RAM.h"
+#include <cstring>
 
 //-------------------------------------------------------------------------
 // Class implementation
@@ -42,12 +43,30 @@ namespace emuzeta80
  *
  * This constructor initializes an instance of the RAM class with the specified size
  * The size parameter determines the total capacity of the RAM in bytes
+ * The storage always covers the whole 64 KiB address space of the Z80 and
+ * is allocated once, so reads and writes never allocate memory
  *
  * @param size The size of the RAM in bytes
  */
 RAM::RAM(uint64_t size)
 {
     this->size = size;
+    capacity = size > 0x10000 ? size : 0x10000;
+    content.assign(capacity + PAGE_SIZE, 0);
+
+    for(unsigned page = 0; page < 0x100; page++)
+    {
+        pages[page] = page * PAGE_SIZE;
+        modes[page] = 0;
+    }
+    trappedPages = 0;
+    trapReads = false;
+    trapWrites = false;
+    romWrites = 0;
+    romWriteCallback = nullptr;
+    romWriteContext = nullptr;
+    watchCallback = nullptr;
+    watchContext = nullptr;
 }
 
 /**
@@ -61,7 +80,26 @@ RAM::RAM(uint64_t size)
  */
 uint8_t RAM::peek(uint64_t position)
 {
-    if(content.count(position) > 0)
+    if(trapReads && position < 0x10000)
+        trapRead(position);
+    if(position < capacity)
+        return content[position];
+
+    return 0;
+}
+
+/**
+ * @brief Reads an instruction byte (opcode or operand) from the RAM
+ *
+ * Same as peek, but never reported to the watch callback: read
+ * watchpoints only see the data reads.
+ *
+ * @param position The memory position to read.
+ * @return The byte value located at the specified memory position.
+ */
+uint8_t RAM::fetch(uint64_t position)
+{
+    if(position < capacity)
         return content[position];
 
     return 0;
@@ -72,14 +110,299 @@ uint8_t RAM::peek(uint64_t position)
  *
  * This function allows writing a byte value into the RAM at the provided memory
  * position. The content of the RAM at the given position will be updated with
- * the new value
+ * the new value, unless the position is in a ROM page (then the write goes
+ * to the discard page, is counted and is reported to the ROM write callback)
  *
  * @param position The memory position where the byte will be written
  * @param value The byte value to be written into the RAM
  */
 void RAM::poke(uint64_t position, uint8_t value)
 {
-    content[position] = value;
+    if(position < 0x10000)
+    {
+        uint32_t offset = pages[position >> 8];
+        content[offset + (position & (PAGE_SIZE - 1))] = value;
+        romWrites += offset == capacity;
+        if(trapWrites)
+            trapWrite(position, value);
+    }
+    else if(position < capacity)
+        content[position] = value;
+}
+
+/**
+ * @brief Copies a block of bytes into the RAM
+ *
+ * Bytes beyond the end of the RAM are ignored. ROM regions are written too
+ *
+ * @param position The memory position where the first byte will be written
+ * @param data The bytes to be written into the RAM
+ * @param length The number of bytes to be written
+ */
+void RAM::load(uint64_t position, const uint8_t* data, uint64_t length)
+{
+    if(position >= capacity)
+        return;
+    if(length > capacity - position)
+        length = capacity - position;
+
+    std::memcpy(content.data() + position, data, length);
+}
+
+/**
+ * @brief Copies a block of bytes from the RAM
+ *
+ * Bytes beyond the end of the RAM are read as 0
+ *
+ * @param position The memory position of the first byte to be read
+ * @param data The buffer where the bytes will be copied
+ * @param length The number of bytes to be read
+ */
+void RAM::save(uint64_t position, uint8_t* data, uint64_t length)
+{
+    for(uint64_t i = 0; i < length; i++)
+        data[i] = peek(position + i);
+}
+
+/**
+ * @brief Moves a block of bytes inside the RAM
+ *
+ * The blocks may overlap (the result is the same as copying the source
+ * block into a temporary buffer first). Blocks must be inside the RAM.
+ * Writes to ROM regions are dropped as in poke.
+ *
+ * @param target The memory position where the first byte will be written
+ * @param source The memory position of the first byte to be read
+ * @param length The number of bytes to be moved
+ */
+void RAM::copy(uint64_t target, uint64_t source, uint64_t length)
+{
+    if(target + length > capacity || source + length > capacity)
+        return;
+
+    if(isProtected(target, length))
+    {
+        // Byte by byte so the writes to ROM are dropped and counted
+        if(target <= source)
+        {
+            for(uint64_t i = 0; i < length; i++)
+                poke(target + i, content[source + i]);
+        }
+        else
+        {
+            for(uint64_t i = length; i > 0; i--)
+                poke(target + i - 1, content[source + i - 1]);
+        }
+        return;
+    }
+
+    std::memmove(content.data() + target, content.data() + source, length);
+}
+
+/**
+ * @brief Sets a block of bytes of the RAM to a value
+ *
+ * Bytes beyond the end of the RAM are ignored. Writes to ROM regions are
+ * dropped as in poke
+ *
+ * @param position The memory position of the first byte to be written
+ * @param value The byte value to be written
+ * @param length The number of bytes to be written
+ */
+void RAM::fill(uint64_t position, uint8_t value, uint64_t length)
+{
+    if(position >= capacity)
+        return;
+    if(length > capacity - position)
+        length = capacity - position;
+
+    if(isProtected(position, length))
+    {
+        for(uint64_t i = 0; i < length; i++)
+            poke(position + i, value);
+        return;
+    }
+
+    std::memset(content.data() + position, value, length);
+}
+
+/**
+ * @brief Marks a region of the first 64 KiB as ROM (or as RAM again)
+ *
+ * Protection is set for whole pages (PAGE_SIZE bytes): every page that
+ * contains a byte of the region is marked.
+ *
+ * @param position The memory position of the first byte of the region
+ * @param length The number of bytes of the region
+ * @param rom true to drop the writes to the region, false to allow them
+ */
+void RAM::protect(uint16_t position, uint32_t length, bool rom)
+{
+    if(length == 0)
+        return;
+
+    uint32_t last = position + length - 1;
+    if(last > 0xFFFF)
+        last = 0xFFFF;
+
+    for(unsigned page = position >> 8; page <= (last >> 8); page++)
+        setMode(page, rom ? (modes[page] | PAGE_ROM) : (modes[page] & ~PAGE_ROM));
+    updateTraps();
+}
+
+/**
+ * @brief Checks if a position is in a ROM region
+ */
+bool RAM::isProtected(uint16_t position)
+{
+    return (modes[position >> 8] & PAGE_ROM) != 0;
+}
+
+/**
+ * @brief Checks if any byte of a block is in a ROM region or a watched page
+ *
+ * The block operations of the CPU are done byte by byte for such blocks.
+ */
+bool RAM::isProtected(uint64_t position, uint64_t length)
+{
+    if(trappedPages == 0 || length == 0 || position >= 0x10000)
+        return false;
+
+    uint64_t last = position + length - 1;
+    if(last > 0xFFFF)
+        last = 0xFFFF;
+
+    for(uint64_t page = position >> 8; page <= (last >> 8); page++)
+    {
+        if(modes[page])
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Checks if reading the RAM has no side effects (no read is reported to the watch callback)
+ *
+ * The CPU only fast-forwards idle loops while the reads are pure.
+ */
+bool RAM::hasPureReads()
+{
+    return !trapReads;
+}
+
+/**
+ * @brief Gets the number of writes dropped by ROM regions
+ */
+uint64_t RAM::getRomWrites()
+{
+    return romWrites;
+}
+
+/**
+ * @brief Sets the function called for every write dropped by a ROM region
+ *
+ * @param callback function called with the context, the address and the value (nullptr: none)
+ * @param context pointer passed to the callback
+ */
+void RAM::setRomWriteCallback(RomWriteCallback callback, void* context)
+{
+    romWriteCallback = callback;
+    romWriteContext = context;
+    updateTraps();
+}
+
+/**
+ * @brief Watches the reads and/or writes of the pages of a region
+ *
+ * Every data access (peek and poke, not fetch) to a watched page
+ * (PAGE_SIZE bytes) is reported to the watch callback, so the callback has
+ * to check the address. The block
+ * instructions of the CPU run byte by byte on watched target pages, but
+ * bulk copies can read a watched source page without reporting it (the
+ * Debugger runs one iteration at a time).
+ *
+ * @param position The memory position of the first byte of the region
+ * @param length The number of bytes of the region
+ * @param read true to report the reads
+ * @param write true to report the writes
+ */
+void RAM::watch(uint16_t position, uint32_t length, bool read, bool write)
+{
+    if(length == 0)
+        return;
+
+    uint32_t last = position + length - 1;
+    if(last > 0xFFFF)
+        last = 0xFFFF;
+
+    uint8_t mode = (read ? PAGE_WATCH_READ : 0) | (write ? PAGE_WATCH_WRITE : 0);
+    for(unsigned page = position >> 8; page <= (last >> 8); page++)
+        setMode(page, (modes[page] & PAGE_ROM) | mode);
+    updateTraps();
+}
+
+/**
+ * @brief Sets the function called for every access to a watched page
+ *
+ * @param callback function called with the context, the address, the value and true for writes (nullptr: none)
+ * @param context pointer passed to the callback
+ */
+void RAM::setWatchCallback(WatchCallback callback, void* context)
+{
+    watchCallback = callback;
+    watchContext = context;
+    updateTraps();
+}
+
+/**
+ * @brief Slow path of the reads of watched pages
+ */
+void RAM::trapRead(uint16_t position)
+{
+    if(modes[position >> 8] & PAGE_WATCH_READ)
+        watchCallback(watchContext, position, content[position], false);
+}
+
+/**
+ * @brief Slow path of the writes to ROM and watched pages
+ *
+ * The value has already been written to the content or the discard page
+ * and a write to ROM has already been counted.
+ */
+void RAM::trapWrite(uint16_t position, uint8_t value)
+{
+    uint8_t mode = modes[position >> 8];
+    if((mode & PAGE_ROM) && romWriteCallback)
+        romWriteCallback(romWriteContext, position, value);
+    if((mode & PAGE_WATCH_WRITE) && watchCallback)
+        watchCallback(watchContext, position, value, true);
+}
+
+/**
+ * @brief Sets the mode of a page and points its writes to the content or the discard page
+ */
+void RAM::setMode(unsigned page, uint8_t mode)
+{
+    trappedPages += (mode != 0) - (modes[page] != 0);
+    modes[page] = mode;
+    pages[page] = (mode & PAGE_ROM) ? capacity : page * PAGE_SIZE;
+}
+
+/**
+ * @brief Enables the slow paths of peek and poke only while they have a callback to call
+ */
+void RAM::updateTraps()
+{
+    uint8_t needed = (romWriteCallback ? PAGE_ROM : 0) | (watchCallback ? PAGE_WATCH_WRITE : 0);
+
+    trapReads = false;
+    trapWrites = false;
+    for(unsigned page = 0; page < 0x100; page++)
+    {
+        trapReads |= watchCallback && (modes[page] & PAGE_WATCH_READ);
+        trapWrites |= (modes[page] & needed) != 0;
+    }
 }
 
 } // namespace emuzeta80
@@ -23,12 +23,16 @@
  *
  */
 
+#pragma once
+
 //-------------------------------------------------------------------------
 // Includes
 //-------------------------------------------------------------------------
 
+#include <cstddef>
 #include <cstdint>
-#include <map>
+#include <cstring>
+#include <vector>
 
 //-------------------------------------------------------------------------
 // Class definition
@@ -37,17 +41,158 @@
 namespace emuzeta80
 {
 
+/**
+ * @brief RAM of the emulated computer, with optional ROM regions and watched pages
+ *
+ * Writes below 64 KiB go through a table of 256 byte pages: the pages
+ * marked as ROM point to a discard buffer, so poke does the same single
+ * lookup for RAM and ROM and counts the dropped writes by comparing the
+ * offset with the discard page (no branch). The slow path of the ROM
+ * write and watch callbacks is only taken while a callback is installed
+ * for a page that needs it. load() writes ROM regions too (to load their
+ * images). Data accesses to watched pages are reported to the watch
+ * callback (the debugger filters the watched addresses); fetch reads the
+ * instruction bytes and is never reported.
+ */
 class RAM
 {
 public:
+    typedef void (*RomWriteCallback)(void* context, uint16_t address, uint8_t value);
+    typedef void (*WatchCallback)(void* context, uint16_t address, uint8_t value, bool write);
+
+    static const unsigned PAGE_SIZE = 0x100;
+
+    enum PageMode
+    {
+        PAGE_ROM = 1,         //< writes are dropped
+        PAGE_WATCH_READ = 2,  //< reads are reported to the watch callback
+        PAGE_WATCH_WRITE = 4  //< writes are reported to the watch callback
+    };
+
     RAM(uint64_t size);
 
     uint8_t peek(uint64_t position);
+    uint8_t fetch(uint64_t position);
     void poke(uint64_t position, uint8_t value);
+    void load(uint64_t position, const uint8_t* data, uint64_t length);
+    void save(uint64_t position, uint8_t* data, uint64_t length);
+    void copy(uint64_t target, uint64_t source, uint64_t length);
+    void fill(uint64_t position, uint8_t value, uint64_t length);
+    void protect(uint16_t position, uint32_t length, bool rom = true);
+    bool isProtected(uint16_t position);
+    bool isProtected(uint64_t position, uint64_t length);
+    bool hasPureReads();
+    uint64_t getRomWrites();
+    void setRomWriteCallback(RomWriteCallback callback, void* context);
+    void watch(uint16_t position, uint32_t length, bool read, bool write);
+    void setWatchCallback(WatchCallback callback, void* context);
 
 protected:
+    void trapRead(uint16_t position);
+    void trapWrite(uint16_t position, uint8_t value);
+    void setMode(unsigned page, uint8_t mode);
+    void updateTraps();
+
     uint64_t size;
-    std::map<uint64_t, uint8_t> content;
+    uint64_t capacity;            //< bytes of content used by the RAM (the discard page follows)
+    std::vector<uint8_t> content;
+    uint32_t pages[0x100];        //< offset in content of the writes to every page
+    uint8_t modes[0x100];         //< PageMode flags of every page
+    unsigned trappedPages;        //< number of pages with any mode
+    bool trapReads;               //< peek calls trapRead (the watch callback is installed for a read watched page)
+    bool trapWrites;              //< poke calls trapWrite (a callback is installed for a ROM or watched page)
+    uint64_t romWrites;           //< writes dropped by ROM pages
+    RomWriteCallback romWriteCallback;
+    void* romWriteContext;
+    WatchCallback watchCallback;
+    void* watchContext;
+};
+
+/**
+ * @brief RAM with the size set at compile time
+ *
+ * The size is a power of two up to 64 KiB; smaller memories are mirrored
+ * across the address space, so accesses are masked instead of checked.
+ * The storage is embedded in the object (no heap indirection).
+ */
+template<size_t Size = 0x10000>
+class FixedRAM
+{
+    static_assert(Size > 0 && Size <= 0x10000 && (Size & (Size - 1)) == 0,
+                  "FixedRAM size must be a power of two up to 64 KiB");
+
+public:
+    FixedRAM(uint64_t size = Size)
+    {
+        (void) size;
+        std::memset(content, 0, Size);
+    }
+
+    uint8_t peek(uint64_t position)
+    {
+        return content[position & (Size - 1)];
+    }
+
+    uint8_t fetch(uint64_t position)
+    {
+        return content[position & (Size - 1)];
+    }
+
+    void poke(uint64_t position, uint8_t value)
+    {
+        content[position & (Size - 1)] = value;
+    }
+
+    void load(uint64_t position, const uint8_t* data, uint64_t length)
+    {
+        for(uint64_t i = 0; i < length; i++)
+            poke(position + i, data[i]);
+    }
+
+    void save(uint64_t position, uint8_t* data, uint64_t length)
+    {
+        for(uint64_t i = 0; i < length; i++)
+            data[i] = peek(position + i);
+    }
+
+    void copy(uint64_t target, uint64_t source, uint64_t length)
+    {
+        if(target + length > Size || source + length > Size)
+        {
+            for(uint64_t i = 0; i < length; i++)
+                poke(target + i, peek(source + i));
+            return;
+        }
+
+        std::memmove(content + target, content + source, length);
+    }
+
+    void fill(uint64_t position, uint8_t value, uint64_t length)
+    {
+        if(position + length > Size)
+        {
+            for(uint64_t i = 0; i < length; i++)
+                poke(position + i, value);
+            return;
+        }
+
+        std::memset(content + position, value, length);
+    }
+
+    bool isProtected(uint64_t position, uint64_t length)
+    {
+        (void) position;
+        (void) length;
+        return false;
+    }
+
+    bool hasPureReads()
+    {
+        return true;
+    }
+
+protected:
+    uint8_t content[Size];
 };
 
 } // namespace emuzeta80
@@ -23,6 +23,8 @@
  *
  */
 
+#pragma once
+
 #include <cstdint>
 
 namespace emuzeta80
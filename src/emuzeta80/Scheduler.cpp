@@ -0,0 +1,261 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Scheduler.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Scheduler class to call devices at given clock cycles
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include "Scheduler.h"
+
+//-------------------------------------------------------------------------
+// Class implementation
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Construct a new Scheduler instance
+ *
+ * @param cpu CPU that drives the clock cycles
+ * @param capacity maximum number of pending events
+ */
+Scheduler::Scheduler(CPU* cpu, unsigned capacity)
+{
+    this->cpu = cpu;
+    events.resize(capacity);
+    heap.reserve(capacity);
+    free.reserve(capacity);
+
+    for(unsigned index = capacity; index > 0; index--)
+    {
+        events[index - 1].position = -1;
+        free.push_back(index - 1);
+    }
+}
+
+/**
+ * @brief Schedule a call at a clock cycle
+ *
+ * Periodic events are scheduled again before every call, so the callback
+ * can cancel them.
+ *
+ * @param cycle clock cycle of the (first) call
+ * @param callback function to call
+ * @param context argument of the callback
+ * @param period cycles between calls (0: called once)
+ * @return identifier of the event (-1 if the capacity is exhausted)
+ */
+int Scheduler::schedule(uint64_t cycle, Callback callback, void* context, uint64_t period)
+{
+    if(free.empty())
+        return -1;
+
+    int event = free.back();
+    free.pop_back();
+
+    events[event].cycle = cycle;
+    events[event].period = period;
+    events[event].callback = callback;
+    events[event].context = context;
+    events[event].position = heap.size();
+    heap.push_back(event);
+    siftUp(events[event].position);
+
+    return event;
+}
+
+/**
+ * @brief Cancel a pending event
+ *
+ * @param event identifier returned by schedule()
+ * @return false if the event is not pending
+ */
+bool Scheduler::cancel(int event)
+{
+    if(event < 0 || event >= (int)events.size() || events[event].position < 0)
+        return false;
+
+    remove(events[event].position);
+    return true;
+}
+
+/**
+ * @brief Execute instructions until a number of clock cycles is consumed
+ *
+ * The CPU runs up to the earliest event without checking the events, then
+ * every event whose cycle has been reached is called.
+ *
+ * @param cycles budget of clock cycles
+ * @return number of executed instructions
+ */
+uint64_t Scheduler::run(uint64_t cycles)
+{
+    uint64_t target = cpu->clockCycles + cycles;
+    uint64_t instructions = 0;
+
+    while(cpu->clockCycles < target)
+    {
+        uint64_t deadline = target;
+        if(!heap.empty() && events[heap[0]].cycle < deadline)
+            deadline = events[heap[0]].cycle;
+
+        if(deadline > cpu->clockCycles)
+            instructions += cpu->run(deadline - cpu->clockCycles);
+
+        dispatch();
+    }
+
+    return instructions;
+}
+
+/**
+ * @brief Get the clock cycle of the earliest pending event
+ *
+ * @return clock cycle (UINT64_MAX if there are no events)
+ */
+uint64_t Scheduler::getNextCycle()
+{
+    return heap.empty() ? UINT64_MAX : events[heap[0]].cycle;
+}
+
+/**
+ * @brief Get the number of pending events
+ */
+unsigned Scheduler::getPending()
+{
+    return heap.size();
+}
+
+/**
+ * @brief Call the events whose clock cycle has been reached
+ */
+void Scheduler::dispatch()
+{
+    while(!heap.empty() && events[heap[0]].cycle <= cpu->clockCycles)
+    {
+        int event = heap[0];
+        uint64_t cycle = events[event].cycle;
+        Callback callback = events[event].callback;
+        void* context = events[event].context;
+
+        if(events[event].period > 0)
+        {
+            events[event].cycle += events[event].period;
+            siftDown(0);
+        }
+        else
+        {
+            remove(0);
+        }
+
+        callback(context, cycle);
+    }
+}
+
+/**
+ * @brief Move an element of the heap up to its place
+ *
+ * @param position index in the heap
+ */
+void Scheduler::siftUp(int position)
+{
+    while(position > 0)
+    {
+        int parent = (position - 1) / 2;
+        if(events[heap[parent]].cycle <= events[heap[position]].cycle)
+            break;
+
+        swap(parent, position);
+        position = parent;
+    }
+}
+
+/**
+ * @brief Move an element of the heap down to its place
+ *
+ * @param position index in the heap
+ */
+void Scheduler::siftDown(int position)
+{
+    int size = heap.size();
+    while(true)
+    {
+        int smallest = position;
+        int left = 2 * position + 1;
+        int right = left + 1;
+
+        if(left < size && events[heap[left]].cycle < events[heap[smallest]].cycle)
+            smallest = left;
+        if(right < size && events[heap[right]].cycle < events[heap[smallest]].cycle)
+            smallest = right;
+        if(smallest == position)
+            break;
+
+        swap(smallest, position);
+        position = smallest;
+    }
+}
+
+/**
+ * @brief Remove an element of the heap and release its event
+ *
+ * @param position index in the heap
+ */
+void Scheduler::remove(int position)
+{
+    int event = heap[position];
+    int last = heap.size() - 1;
+
+    if(position != last)
+    {
+        swap(position, last);
+        heap.pop_back();
+        siftDown(position);
+        siftUp(position);
+    }
+    else
+    {
+        heap.pop_back();
+    }
+
+    events[event].position = -1;
+    free.push_back(event);
+}
+
+/**
+ * @brief Exchange two elements of the heap
+ */
+void Scheduler::swap(int a, int b)
+{
+    int event = heap[a];
+    heap[a] = heap[b];
+    heap[b] = event;
+
+    events[heap[a]].position = a;
+    events[heap[b]].position = b;
+}
+
+} // namespace emuzeta80
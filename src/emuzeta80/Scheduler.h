@@ -0,0 +1,89 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Scheduler.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Scheduler class to call devices at given clock cycles
+ *
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <cstdint>
+#include <vector>
+
+#include "CPU.h"
+
+//-------------------------------------------------------------------------
+// Class definition
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Runs a CPU and calls the events scheduled by the devices
+ *
+ * Events are kept in a binary min-heap of fixed capacity ordered by clock
+ * cycle, so scheduling, cancelling and dispatching are O(log n) and do not
+ * allocate memory. The CPU runs without checking the events until the
+ * earliest one (CPU::run), which is called once its cycle is reached. An
+ * event may be called after the exact cycle by the length of the last
+ * instruction; the callback receives the scheduled cycle.
+ */
+class Scheduler
+{
+public:
+    typedef void (*Callback)(void* context, uint64_t cycle);
+
+    Scheduler(CPU* cpu, unsigned capacity = 64);
+
+    int schedule(uint64_t cycle, Callback callback, void* context, uint64_t period = 0);
+    bool cancel(int event);
+    uint64_t run(uint64_t cycles);
+    uint64_t getNextCycle();
+    unsigned getPending();
+
+protected:
+    struct Event
+    {
+        uint64_t cycle;    //< clock cycle of the next call
+        uint64_t period;   //< cycles between calls (0: called once)
+        Callback callback;
+        void* context;
+        int position;      //< index in the heap (-1 if free)
+    };
+
+    void dispatch();
+    void siftUp(int position);
+    void siftDown(int position);
+    void remove(int position);
+    void swap(int a, int b);
+
+    CPU* cpu;
+    std::vector<Event> events; //< events by identifier
+    std::vector<int> heap;     //< identifiers ordered by cycle
+    std::vector<int> free;     //< identifiers not in use
+};
+
+} // namespace emuzeta80
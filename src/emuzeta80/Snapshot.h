@@ -0,0 +1,51 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Snapshot.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Copy of the registers of a CPU
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "RegistersBank.h"
+
+namespace emuzeta80
+{
+
+struct Snapshot
+{
+    RegistersBank mainBank;
+    RegistersBank alternateBank;
+    Register pc;
+    Register sp;
+    Register iX;
+    Register iY;
+    uint8_t i;
+    uint8_t r;
+    bool iff1;
+    bool iff2;
+    uint8_t im;
+    bool interruptDelay;
+    uint64_t clockCycles;
+};
+
+} // namespace emuzeta80
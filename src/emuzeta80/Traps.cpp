@@ -0,0 +1,245 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Traps.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Traps class to replace guest routines with host functions
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include "Traps.h"
+
+//-------------------------------------------------------------------------
+// Class implementation
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+namespace
+{
+
+const uint64_t ADDRESS_SPACE = 0x10000;   //< Memory compared in verification mode
+const uint64_t VERIFY_LIMIT = 100000000;  //< Clock cycles to wait for the RET of a guest routine
+
+} // namespace
+
+/**
+ * @brief Construct a new Traps instance (no routines registered)
+ *
+ * @param cpu CPU to run
+ */
+Traps::Traps(CPU* cpu)
+{
+    this->cpu = cpu;
+    slots.assign(ADDRESS_SPACE, -1);
+}
+
+/**
+ * @brief Register the native replacement of a routine
+ *
+ * A routine registered before at the same address is replaced.
+ *
+ * @param address entry point of the guest routine
+ * @param routine native function
+ * @param context argument of the native function
+ * @param cycles clock cycles added on every call (including the RET)
+ * @param exact the cycles (plus the ones returned by the routine) are the ones of the guest routine
+ */
+void Traps::add(uint16_t address, Routine routine, void* context, uint64_t cycles, bool exact)
+{
+    if(slots[address] < 0)
+    {
+        // Reuse an entry released by remove() before growing the list
+        if(unused.empty())
+        {
+            slots[address] = traps.size();
+            traps.push_back(Trap());
+        }
+        else
+        {
+            slots[address] = unused.back();
+            unused.pop_back();
+        }
+    }
+
+    Trap& trap = traps[slots[address]];
+    trap.routine = routine;
+    trap.context = context;
+    trap.cycles = cycles;
+    trap.calls = 0;
+    trap.mismatches = 0;
+    trap.exact = exact;
+    trap.difference = 0;
+}
+
+/**
+ * @brief Remove the native replacement of a routine
+ *
+ * @param address entry point of the guest routine
+ * @return false if no routine is registered at the address
+ */
+bool Traps::remove(uint16_t address)
+{
+    if(slots[address] < 0)
+        return false;
+
+    unused.push_back(slots[address]);
+    slots[address] = -1;
+    return true;
+}
+
+/**
+ * @brief Run the CPU for a number of clock cycles calling the native routines
+ *
+ * @param cycles clock cycles to run (the last instruction or routine may exceed them)
+ * @return number of executed instructions (a native routine counts as one)
+ */
+uint64_t Traps::run(uint64_t cycles)
+{
+    uint64_t target = cpu->clockCycles + cycles;
+    uint64_t start = cpu->instructionCount;
+
+    cpu->deadline = target;
+    while(cpu->clockCycles < target)
+    {
+        int slot = slots[cpu->pc.value];
+        if(slot >= 0 && !(cpu->interruptPending && cpu->iff1))
+        {
+            cpu->interruptDelay = false;
+            if(verify)
+            {
+                check(traps[slot]);
+            }
+            else
+            {
+                call(traps[slot]);
+                cpu->instructionCount++;
+            }
+            continue;
+        }
+
+        cpu->execute();
+    }
+    cpu->deadline = 0;
+
+    return cpu->instructionCount - start;
+}
+
+/**
+ * @brief Get the number of calls to a routine
+ *
+ * @param address entry point of the guest routine
+ * @return calls since the routine was registered
+ */
+uint64_t Traps::getCalls(uint16_t address)
+{
+    return slots[address] < 0 ? 0 : traps[slots[address]].calls;
+}
+
+/**
+ * @brief Get the number of native results different from the guest routine
+ *
+ * @param address entry point of the guest routine
+ * @return mismatches found in verification mode
+ */
+uint64_t Traps::getMismatches(uint16_t address)
+{
+    return slots[address] < 0 ? 0 : traps[slots[address]].mismatches;
+}
+
+/**
+ * @brief Get the clock cycles of the guest routine minus the native ones
+ *
+ * @param address entry point of the guest routine
+ * @return difference accumulated in verification mode (positive: the declared cost is too low)
+ */
+int64_t Traps::getCycleDifference(uint16_t address)
+{
+    return slots[address] < 0 ? 0 : traps[slots[address]].difference;
+}
+
+/**
+ * @brief Call the native function of a routine and return to the caller
+ *
+ * @param trap registered routine
+ */
+void Traps::call(Trap& trap)
+{
+    trap.calls++;
+    cpu->clockCycles += trap.cycles + trap.routine(trap.context, &cpu->mainBank, cpu->memory);
+
+    // RET
+    uint8_t low = cpu->memory->peek(cpu->sp.value++);
+    uint8_t high = cpu->memory->peek(cpu->sp.value++);
+    cpu->pc.value = low | (high << 8);
+}
+
+/**
+ * @brief Run a guest routine and compare its result with the native function
+ *
+ * The guest routine runs until it returns to the caller (or VERIFY_LIMIT
+ * cycles), and its result is kept. The flags are not compared, the clock
+ * cycles only for routines with exact cycles.
+ *
+ * @param trap registered routine
+ * @return number of instructions of the guest routine
+ */
+uint64_t Traps::check(Trap& trap)
+{
+    Snapshot entry, native;
+    entryMemory.resize(ADDRESS_SPACE);
+    nativeMemory.resize(ADDRESS_SPACE);
+
+    cpu->save(entry);
+    cpu->memory->save(0, entryMemory.data(), ADDRESS_SPACE);
+
+    call(trap);
+    cpu->save(native);
+    cpu->memory->save(0, nativeMemory.data(), ADDRESS_SPACE);
+
+    cpu->restore(entry);
+    cpu->memory->load(0, entryMemory.data(), ADDRESS_SPACE);
+
+    uint64_t limit = cpu->clockCycles + VERIFY_LIMIT;
+    uint64_t start = cpu->instructionCount;
+    do
+    {
+        cpu->execute();
+    } while((cpu->pc.value != native.pc.value || cpu->sp.value != native.sp.value) && cpu->clockCycles < limit);
+
+    int64_t difference = (int64_t)(cpu->clockCycles - native.clockCycles);
+    trap.difference += difference;
+
+    // The entry memory is no longer needed: reuse it for the guest result
+    cpu->memory->save(0, entryMemory.data(), ADDRESS_SPACE);
+    if(cpu->pc.value != native.pc.value || cpu->sp.value != native.sp.value ||
+       cpu->mainBank.af.bytes.H != native.mainBank.af.bytes.H || cpu->mainBank.bc.value != native.mainBank.bc.value ||
+       cpu->mainBank.de.value != native.mainBank.de.value || cpu->mainBank.hl.value != native.mainBank.hl.value ||
+       entryMemory != nativeMemory || (trap.exact && difference != 0))
+        trap.mismatches++;
+
+    return cpu->instructionCount - start;
+}
+
+} // namespace emuzeta80
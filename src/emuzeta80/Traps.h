@@ -0,0 +1,100 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file Traps.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Traps class to replace guest routines with host functions
+ *
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <cstdint>
+#include <vector>
+
+#include "CPU.h"
+
+//-------------------------------------------------------------------------
+// Class definition
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Runs a CPU replacing the registered routines with native functions
+ *
+ * When PC reaches the address of a registered routine (called with CALL or
+ * RST), the native function updates the registers and the memory, the
+ * declared cycles are added to the clock and the RET is emulated. Traps are
+ * not taken while an interrupt can be accepted.
+ *
+ * In verification mode the routine runs on the emulated CPU and its result
+ * (main registers but F, PC, SP and the first 64 KB of memory) is compared
+ * with the one of the native function, which is discarded. The difference of
+ * clock cycles is accumulated and, for routines declared with exact cycles,
+ * counted as a mismatch.
+ */
+class Traps
+{
+public:
+    // Returns the cycles added to the declared cost (data dependent routines)
+    typedef uint64_t (*Routine)(void* context, RegistersBank* bank, RAM* memory);
+
+    Traps(CPU* cpu);
+
+    void add(uint16_t address, Routine routine, void* context, uint64_t cycles, bool exact = false);
+    bool remove(uint16_t address);
+    uint64_t run(uint64_t cycles);
+    uint64_t getCalls(uint16_t address);
+    uint64_t getMismatches(uint16_t address);
+    int64_t getCycleDifference(uint16_t address);
+
+    bool verify = false; //< Run the guest routines and compare the native results
+
+protected:
+    struct Trap
+    {
+        Routine routine;
+        void* context;
+        uint64_t cycles;     //< declared cost (including the RET)
+        uint64_t calls;
+        uint64_t mismatches; //< results different from the guest routine (verification mode)
+        bool exact;          //< cycles must match the guest routine (verification mode)
+        int64_t difference;  //< guest minus native clock cycles (verification mode)
+    };
+
+    void call(Trap& trap);
+    uint64_t check(Trap& trap);
+
+    CPU* cpu;
+    std::vector<int> slots;   //< trap by address (-1: none)
+    std::vector<Trap> traps;
+    std::vector<int> unused;  //< entries of traps released by remove()
+
+    // Memory at the entry of the routine and after the native function (verification mode)
+    std::vector<uint8_t> entryMemory;
+    std::vector<uint8_t> nativeMemory;
+};
+
+} // namespace emuzeta80
@@ -0,0 +1,194 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file emuzeta80.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief C interface of the Z80 emulator
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include "emuzeta80.h"
+#include "CPU.h"
+
+//-------------------------------------------------------------------------
+// Implementation
+//-------------------------------------------------------------------------
+
+using emuzeta80::CPU;
+using emuzeta80::Snapshot;
+
+struct emuzeta80_cpu
+{
+    explicit emuzeta80_cpu(uint64_t ramSize) : cpu(ramSize) { }
+
+    // Aligned allocation of the CPU
+    static void* operator new(size_t size) { return CPU::operator new(size); }
+    static void operator delete(void* pointer) { CPU::operator delete(pointer); }
+
+    CPU cpu;
+};
+
+/**
+ * @brief Version of the C interface implemented by the library
+ */
+uint32_t emuzeta80_abi_version(void)
+{
+    return EMUZETA80_ABI_VERSION;
+}
+
+/**
+ * @brief Create a CPU with its RAM (registers set to 0)
+ *
+ * @param ram_size size of the RAM in bytes
+ * @return handle of the CPU (NULL if it could not be allocated)
+ */
+emuzeta80_cpu* emuzeta80_create(uint64_t ram_size)
+{
+    try
+    {
+        return new emuzeta80_cpu(ram_size);
+    }
+    catch(...)
+    {
+        return nullptr;
+    }
+}
+
+/**
+ * @brief Destroy a CPU and its RAM
+ */
+void emuzeta80_destroy(emuzeta80_cpu* cpu)
+{
+    delete cpu;
+}
+
+/**
+ * @brief Copy bytes into memory (ROM regions included)
+ */
+void emuzeta80_load(emuzeta80_cpu* cpu, uint16_t address, const uint8_t* data, uint32_t length)
+{
+    cpu->cpu.memory->load(address, data, length);
+}
+
+/**
+ * @brief Copy bytes from memory
+ */
+void emuzeta80_save(emuzeta80_cpu* cpu, uint16_t address, uint8_t* data, uint32_t length)
+{
+    cpu->cpu.memory->save(address, data, length);
+}
+
+/**
+ * @brief Run a CPU for a number of clock cycles (see CPU::run)
+ *
+ * @return number of executed instructions
+ */
+uint64_t emuzeta80_run(emuzeta80_cpu* cpu, uint64_t cycles)
+{
+    return cpu->cpu.run(cycles);
+}
+
+/**
+ * @brief Run several CPUs for the same number of clock cycles in one call
+ *
+ * @param cpus handles of the CPUs
+ * @param count number of CPUs
+ * @param cycles clock cycles of every CPU
+ * @param instructions executed instructions of every CPU (NULL to ignore them)
+ */
+void emuzeta80_run_batch(emuzeta80_cpu* const* cpus, size_t count, uint64_t cycles, uint64_t* instructions)
+{
+    for(size_t index = 0; index < count; index++)
+    {
+        uint64_t executed = cpus[index]->cpu.run(cycles);
+        if(instructions != nullptr)
+            instructions[index] = executed;
+    }
+}
+
+/**
+ * @brief Request a maskable interrupt (see CPU::interrupt)
+ */
+void emuzeta80_interrupt(emuzeta80_cpu* cpu, uint8_t data)
+{
+    cpu->cpu.interrupt(data);
+}
+
+/**
+ * @brief Copy the registers and the interrupt state of a CPU
+ */
+void emuzeta80_get_state(emuzeta80_cpu* cpu, emuzeta80_state* state)
+{
+    Snapshot snapshot;
+    cpu->cpu.save(snapshot);
+
+    state->af = snapshot.mainBank.af.value;
+    state->bc = snapshot.mainBank.bc.value;
+    state->de = snapshot.mainBank.de.value;
+    state->hl = snapshot.mainBank.hl.value;
+    state->af_alt = snapshot.alternateBank.af.value;
+    state->bc_alt = snapshot.alternateBank.bc.value;
+    state->de_alt = snapshot.alternateBank.de.value;
+    state->hl_alt = snapshot.alternateBank.hl.value;
+    state->ix = snapshot.iX.value;
+    state->iy = snapshot.iY.value;
+    state->sp = snapshot.sp.value;
+    state->pc = snapshot.pc.value;
+    state->i = snapshot.i;
+    state->r = snapshot.r;
+    state->iff1 = snapshot.iff1;
+    state->iff2 = snapshot.iff2;
+    state->im = snapshot.im;
+    state->interrupt_delay = snapshot.interruptDelay;
+    state->reserved[0] = state->reserved[1] = 0;
+    state->clock_cycles = snapshot.clockCycles;
+}
+
+/**
+ * @brief Set the registers and the interrupt state of a CPU
+ */
+void emuzeta80_set_state(emuzeta80_cpu* cpu, const emuzeta80_state* state)
+{
+    Snapshot snapshot = Snapshot();
+    snapshot.mainBank.af.value = state->af;
+    snapshot.mainBank.bc.value = state->bc;
+    snapshot.mainBank.de.value = state->de;
+    snapshot.mainBank.hl.value = state->hl;
+    snapshot.alternateBank.af.value = state->af_alt;
+    snapshot.alternateBank.bc.value = state->bc_alt;
+    snapshot.alternateBank.de.value = state->de_alt;
+    snapshot.alternateBank.hl.value = state->hl_alt;
+    snapshot.iX.value = state->ix;
+    snapshot.iY.value = state->iy;
+    snapshot.sp.value = state->sp;
+    snapshot.pc.value = state->pc;
+    snapshot.i = state->i;
+    snapshot.r = state->r;
+    snapshot.iff1 = state->iff1 != 0;
+    snapshot.iff2 = state->iff2 != 0;
+    snapshot.im = state->im;
+    snapshot.interruptDelay = state->interrupt_delay != 0;
+    snapshot.clockCycles = state->clock_cycles;
+
+    cpu->cpu.restore(snapshot);
+}
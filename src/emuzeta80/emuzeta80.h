@@ -0,0 +1,81 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file emuzeta80.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief C interface of the Z80 emulator (for FFI from other languages)
+ *
+ * The handle is opaque and every function is extern "C". The layout of
+ * the structures and the signatures only change with EMUZETA80_ABI_VERSION;
+ * check emuzeta80_abi_version() against it after loading the library.
+ *
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EMUZETA80_ABI_VERSION 1
+
+#if defined(_WIN32)
+#define EMUZETA80_API __declspec(dllexport)
+#else
+#define EMUZETA80_API __attribute__((visibility("default")))
+#endif
+
+typedef struct emuzeta80_cpu emuzeta80_cpu;
+
+/* Registers and interrupt state (the alternate bank is af_alt...hl_alt) */
+typedef struct emuzeta80_state
+{
+    uint16_t af, bc, de, hl;
+    uint16_t af_alt, bc_alt, de_alt, hl_alt;
+    uint16_t ix, iy, sp, pc;
+    uint8_t i, r;
+    uint8_t iff1, iff2;
+    uint8_t im;
+    uint8_t interrupt_delay;
+    uint8_t reserved[2];
+    uint64_t clock_cycles;
+} emuzeta80_state;
+
+EMUZETA80_API uint32_t emuzeta80_abi_version(void);
+
+EMUZETA80_API emuzeta80_cpu* emuzeta80_create(uint64_t ram_size);
+EMUZETA80_API void emuzeta80_destroy(emuzeta80_cpu* cpu);
+
+EMUZETA80_API void emuzeta80_load(emuzeta80_cpu* cpu, uint16_t address, const uint8_t* data, uint32_t length);
+EMUZETA80_API void emuzeta80_save(emuzeta80_cpu* cpu, uint16_t address, uint8_t* data, uint32_t length);
+
+EMUZETA80_API uint64_t emuzeta80_run(emuzeta80_cpu* cpu, uint64_t cycles);
+EMUZETA80_API void emuzeta80_run_batch(emuzeta80_cpu* const* cpus, size_t count, uint64_t cycles,
+                                       uint64_t* instructions);
+EMUZETA80_API void emuzeta80_interrupt(emuzeta80_cpu* cpu, uint8_t data);
+
+EMUZETA80_API void emuzeta80_get_state(emuzeta80_cpu* cpu, emuzeta80_state* state);
+EMUZETA80_API void emuzeta80_set_state(emuzeta80_cpu* cpu, const emuzeta80_state* state);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,42 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file emuzeta80_unity.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Unity build of the Z80 emulator
+ *
+ * Every source of the library in one translation unit, compiled into the
+ * executable that uses it (emuzeta80_unity CMake target or added to the
+ * sources of the host). The calls between the classes (CPU, RAM, ALU...)
+ * are inlined without LTO and there are no calls through the PLT.
+ *
+ */
+
+#include "ALU.cpp"
+#include "RAM.cpp"
+#include "Bus.cpp"
+#include "CPU.cpp"
+#include "Farm.cpp"
+#include "Lockstep.cpp"
+#include "Scheduler.cpp"
+#include "Fusion.cpp"
+#include "Traps.cpp"
+#include "Debugger.cpp"
+#include "GdbServer.cpp"
+#include "emuzeta80.cpp"
@@ -0,0 +1,155 @@
+#include "CPUImpl.h"
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace emuzeta80;
+
+namespace
+{
+
+// 0000: LD A, 55h / LD (1000h), A / LD (9000h), A
+// 0008: LD HL, 9000h / LD DE, 2000h / LD BC, 0010h / LDIR
+// 0013: LD DE, A000h / LD HL, 9000h / LD BC, 0010h / LDIR / JR 001Eh
+const std::vector<uint8_t> PROGRAM = {0x3E, 0x55, 0x32, 0x00, 0x10, 0x32, 0x00, 0x90, 0x21, 0x00, 0x90,
+                                      0x11, 0x00, 0x20, 0x01, 0x10, 0x00, 0xED, 0xB0, 0x11, 0x00, 0xA0,
+                                      0x21, 0x00, 0x90, 0x01, 0x10, 0x00, 0xED, 0xB0, 0x18, 0xFE};
+
+/**
+ * @brief Bus resolved at compile time with ROM at 0000h-3FFFh
+ */
+class RomBus : public BusBase<RomBus>
+{
+public:
+	RomBus(uint64_t size) : violations(0)
+	{
+		(void) size;
+		std::memset(content, 0, sizeof(content));
+	}
+
+	uint8_t peek(uint64_t position) { return content[position & 0xFFFF]; }
+
+	void poke(uint64_t position, uint8_t value)
+	{
+		if((position & 0xFFFF) < 0x4000)
+			violations++;
+		else
+			content[position & 0xFFFF] = value;
+	}
+
+	uint8_t content[0x10000];
+	uint64_t violations;
+};
+
+/**
+ * @brief Bus with virtual accessors and ROM at 0000h-3FFFh
+ */
+class VirtualRomBus : public Bus
+{
+public:
+	VirtualRomBus() : violations(0) { }
+
+	void poke(uint64_t position, uint8_t value) override
+	{
+		if((position & 0xFFFF) < 0x4000)
+			violations++;
+		else
+			Bus::poke(position, value);
+	}
+
+	void loadRom(const std::vector<uint8_t>& data) { ram.load(0, data.data(), data.size()); }
+
+	uint64_t violations;
+};
+
+/**
+ * @brief Bus with a status register at 9000h that reads 1 from the 11th read
+ */
+class StatusBus : public Bus
+{
+public:
+	StatusBus() : reads(0) { }
+
+	uint8_t peek(uint64_t position) override
+	{
+		if((position & 0xFFFF) == 0x9000)
+			return reads++ >= 10 ? 0x01 : 0x00;
+		return Bus::peek(position);
+	}
+
+	uint64_t reads;
+};
+
+template<class T>
+void checkProtected(T& cpu)
+{
+	ASSERT_EQ(cpu.memory->peek(0x1000), 0x00);
+	ASSERT_EQ(cpu.memory->peek(0x9000), 0x55);
+	ASSERT_EQ(cpu.memory->peek(0xA000), 0x55);
+	for(uint16_t address = 0x2000; address < 0x2010; address++)
+		ASSERT_EQ(cpu.memory->peek(address), 0x00);
+}
+
+} // namespace
+
+template class emuzeta80::BasicCPU<RomBus>;
+
+TEST(EmuZeta80BusTest, COMPILE_TIME_BUS)
+{
+	BasicCPU<RomBus> cpu;
+	std::memcpy(cpu.memory->content, PROGRAM.data(), PROGRAM.size());
+
+	cpu.run(2000);
+	ASSERT_EQ(cpu.pc.value, 0x001E);
+	checkProtected(cpu);
+	ASSERT_EQ(cpu.memory->violations, 17u);
+
+	// Step by step (CPU::execute) gives the same result
+	BasicCPU<RomBus> single;
+	std::memcpy(single.memory->content, PROGRAM.data(), PROGRAM.size());
+	while(single.pc.value != 0x001E)
+		single.execute();
+	checkProtected(single);
+	ASSERT_EQ(single.memory->violations, 17u);
+}
+
+TEST(EmuZeta80BusTest, VIRTUAL_BUS)
+{
+	VirtualRomBus bus;
+	bus.loadRom(PROGRAM);
+	VirtualCPU cpu(&bus);
+
+	cpu.run(2000);
+	ASSERT_EQ(cpu.pc.value, 0x001E);
+	checkProtected(cpu);
+	ASSERT_EQ(bus.violations, 17u);
+}
+
+TEST(EmuZeta80BusTest, SAME_AS_CPU)
+{
+	CPU expected(0x10000);
+	VirtualCPU actual;
+	expected.memory->load(0, PROGRAM.data(), PROGRAM.size());
+	actual.memory->load(0, PROGRAM.data(), PROGRAM.size());
+
+	ASSERT_EQ(expected.run(2000), actual.run(2000));
+	ASSERT_EQ(expected.pc.value, actual.pc.value);
+	ASSERT_EQ(expected.clockCycles, actual.clockCycles);
+	for(uint32_t address = 0; address < 0x10000; address++)
+		ASSERT_EQ(expected.memory->peek(address), actual.memory->peek(address));
+}
+
+TEST(EmuZeta80BusTest, IDLE_LOOP_NOT_SKIPPED)
+{
+	// 0000: LD A, (9000h) / AND 01h / JR Z, 0000h / HALT
+	const std::vector<uint8_t> program = {0x3A, 0x00, 0x90, 0xE6, 0x01, 0x28, 0xF9, 0x76};
+	StatusBus bus;
+	bus.load(0, program.data(), program.size());
+	VirtualCPU cpu(&bus);
+	cpu.skipIdleLoops = true;
+
+	// Every poll is a read of the device
+	cpu.run(10000);
+	ASSERT_EQ(bus.reads, 11u);
+	ASSERT_EQ(cpu.mainBank.af.bytes.H, 0x01);
+}
@@ -0,0 +1,81 @@
+#include "emuzeta80.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace
+{
+
+// 0000: LD B, 00h / INC A / DJNZ 0002h / INC C / JP 0000h
+const std::vector<uint8_t> PROGRAM = {0x06, 0x00, 0x3C, 0x10, 0xFD, 0x0C, 0xC3, 0x00, 0x00};
+
+} // namespace
+
+TEST(EmuZeta80CTest, ABI_VERSION)
+{
+	ASSERT_EQ(emuzeta80_abi_version(), (uint32_t)EMUZETA80_ABI_VERSION);
+}
+
+TEST(EmuZeta80CTest, STATE_AND_MEMORY)
+{
+	emuzeta80_cpu* cpu = emuzeta80_create(0x10000);
+	ASSERT_NE(cpu, nullptr);
+
+	emuzeta80_state state = {};
+	state.af = 0x1234;
+	state.hl_alt = 0x5678;
+	state.ix = 0x9ABC;
+	state.pc = 0x0100;
+	state.iff1 = 1;
+	state.im = 2;
+	state.clock_cycles = 1000;
+	emuzeta80_set_state(cpu, &state);
+
+	emuzeta80_state copy;
+	emuzeta80_get_state(cpu, &copy);
+	ASSERT_EQ(copy.af, 0x1234);
+	ASSERT_EQ(copy.hl_alt, 0x5678);
+	ASSERT_EQ(copy.ix, 0x9ABC);
+	ASSERT_EQ(copy.pc, 0x0100);
+	ASSERT_EQ(copy.iff1, 1);
+	ASSERT_EQ(copy.iff2, 0);
+	ASSERT_EQ(copy.im, 2);
+	ASSERT_EQ(copy.clock_cycles, 1000u);
+
+	uint8_t bytes[3] = {};
+	emuzeta80_load(cpu, 0xFFFE, PROGRAM.data(), 3);
+	emuzeta80_save(cpu, 0xFFFE, bytes, 3);
+	ASSERT_EQ(bytes[0], 0x06);
+	ASSERT_EQ(bytes[1], 0x00);
+
+	emuzeta80_destroy(cpu);
+	emuzeta80_destroy(nullptr);
+}
+
+TEST(EmuZeta80CTest, RUN_BATCH)
+{
+	std::vector<emuzeta80_cpu*> cpus;
+	for(int i = 0; i < 4; i++)
+	{
+		cpus.push_back(emuzeta80_create(0x10000));
+		emuzeta80_load(cpus.back(), 0, PROGRAM.data(), PROGRAM.size());
+	}
+	emuzeta80_cpu* single = emuzeta80_create(0x10000);
+	emuzeta80_load(single, 0, PROGRAM.data(), PROGRAM.size());
+
+	std::vector<uint64_t> instructions(cpus.size());
+	emuzeta80_run_batch(cpus.data(), cpus.size(), 50000, instructions.data());
+	uint64_t expected = emuzeta80_run(single, 50000);
+
+	emuzeta80_state reference, state;
+	emuzeta80_get_state(single, &reference);
+	for(size_t i = 0; i < cpus.size(); i++)
+	{
+		ASSERT_EQ(instructions[i], expected);
+		emuzeta80_get_state(cpus[i], &state);
+		ASSERT_EQ(state.pc, reference.pc);
+		ASSERT_EQ(state.bc, reference.bc);
+		ASSERT_EQ(state.clock_cycles, reference.clock_cycles);
+		emuzeta80_destroy(cpus[i]);
+	}
+	emuzeta80_destroy(single);
+}
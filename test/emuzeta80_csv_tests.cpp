@@ -0,0 +1,328 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file emuzeta80_csv_tests.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Data-driven opcode tests from emuzeta80_tests.csv
+ *
+ * Each row of the CSV file has the columns:
+ *   name, initial state, opcode bytes, expected cycles, expected state
+ * States are lists of assignments separated by ';' (a=0x10;hl=0x8000;[0x8000]=0x17)
+ * and bytes are lists of values separated by ';'. Rows starting with '#' are skipped.
+ *
+ * The file is parsed once and every row runs against every registered engine,
+ * spreading the rows over all hardware threads.
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "emuzeta80_engines.h"
+
+#ifndef EMUZETA80_TESTS_CSV
+#define EMUZETA80_TESTS_CSV "emuzeta80_tests.csv"
+#endif
+
+using namespace emuzeta80;
+
+//-------------------------------------------------------------------------
+// CSV parsing
+//-------------------------------------------------------------------------
+
+namespace
+{
+
+struct Assignment
+{
+	std::string target; //< register name or [address]
+	uint16_t value;
+};
+
+struct TestCase
+{
+	std::string name;
+	std::vector<Assignment> initial;
+	std::vector<uint8_t> opcodes;
+	uint64_t cycles;
+	std::vector<Assignment> expected;
+};
+
+std::vector<std::string> split(const std::string& text, char separator)
+{
+	std::vector<std::string> fields;
+	std::stringstream stream(text);
+	std::string field;
+	while(std::getline(stream, field, separator))
+		fields.push_back(field);
+
+	// A trailing separator means a last empty field
+	if(!text.empty() && text.back() == separator)
+		fields.push_back("");
+
+	return fields;
+}
+
+uint16_t parseNumber(const std::string& text)
+{
+	if(text.compare(0, 2, "0b") == 0)
+		return (uint16_t)std::strtoul(text.c_str() + 2, nullptr, 2);
+
+	return (uint16_t)std::strtoul(text.c_str(), nullptr, 0);
+}
+
+std::vector<Assignment> parseState(const std::string& text)
+{
+	std::vector<Assignment> state;
+	for(auto& item : split(text, ';'))
+	{
+		auto equal = item.find('=');
+		if(equal == std::string::npos)
+			continue;
+
+		state.push_back({item.substr(0, equal), parseNumber(item.substr(equal + 1))});
+	}
+
+	return state;
+}
+
+std::vector<TestCase> loadTestCases(const char* path)
+{
+	std::vector<TestCase> cases;
+	std::ifstream file(path);
+	std::string line;
+	while(std::getline(file, line))
+	{
+		if(line.empty() || line[0] == '#')
+			continue;
+
+		auto fields = split(line, ',');
+		if(fields.size() != 5)
+			continue;
+
+		TestCase test;
+		test.name = fields[0];
+		test.initial = parseState(fields[1]);
+		for(auto& byte : split(fields[2], ';'))
+			test.opcodes.push_back((uint8_t)parseNumber(byte));
+		test.cycles = parseNumber(fields[3]);
+		test.expected = parseState(fields[4]);
+		cases.push_back(test);
+	}
+
+	return cases;
+}
+
+const std::vector<TestCase>& testCases()
+{
+	static const std::vector<TestCase> cases = loadTestCases(EMUZETA80_TESTS_CSV);
+	return cases;
+}
+
+//-------------------------------------------------------------------------
+// Machine state access by name
+//-------------------------------------------------------------------------
+
+/**
+ * @brief Get a pointer to a 16-bit register or a byte of it
+ *
+ * @param high set to 1 (H) or 0 (L) for 8-bit registers, -1 for 16-bit registers
+ * @return register or nullptr if the name is unknown
+ */
+Register* findRegister(Machine& machine, const std::string& name, int& high)
+{
+	static const struct
+	{
+		const char* name;
+		int bank; //< 0: main bank, 1: pc, 2: sp, 3: iX, 4: iY
+		Register RegistersBank::*reg;
+		int high;
+	} registers[] = {
+		{"a", 0, &RegistersBank::af, 1}, {"f", 0, &RegistersBank::af, 0},
+		{"b", 0, &RegistersBank::bc, 1}, {"c", 0, &RegistersBank::bc, 0},
+		{"d", 0, &RegistersBank::de, 1}, {"e", 0, &RegistersBank::de, 0},
+		{"h", 0, &RegistersBank::hl, 1}, {"l", 0, &RegistersBank::hl, 0},
+		{"af", 0, &RegistersBank::af, -1}, {"bc", 0, &RegistersBank::bc, -1},
+		{"de", 0, &RegistersBank::de, -1}, {"hl", 0, &RegistersBank::hl, -1},
+		{"pc", 1, nullptr, -1}, {"sp", 2, nullptr, -1},
+		{"ix", 3, nullptr, -1}, {"iy", 4, nullptr, -1},
+	};
+
+	for(auto& entry : registers)
+	{
+		if(name != entry.name)
+			continue;
+
+		high = entry.high;
+		switch(entry.bank)
+		{
+		case 0: return &(machine.mainBank->*entry.reg);
+		case 1: return machine.pc;
+		case 2: return machine.sp;
+		case 3: return machine.iX;
+		default: return machine.iY;
+		}
+	}
+
+	return nullptr;
+}
+
+bool isAddress(const std::string& target)
+{
+	return target.size() > 2 && target.front() == '[' && target.back() == ']';
+}
+
+uint16_t addressOf(const std::string& target)
+{
+	return parseNumber(target.substr(1, target.size() - 2));
+}
+
+void apply(Machine& machine, const Assignment& assignment)
+{
+	if(isAddress(assignment.target))
+	{
+		machine.poke(addressOf(assignment.target), (uint8_t)assignment.value);
+		return;
+	}
+
+	int high;
+	Register* reg = findRegister(machine, assignment.target, high);
+	if(reg == nullptr)
+		return;
+
+	if(high < 0)
+		reg->value = assignment.value;
+	else if(high)
+		reg->bytes.H = (uint8_t)assignment.value;
+	else
+		reg->bytes.L = (uint8_t)assignment.value;
+}
+
+/**
+ * @brief Read the current value of a register or memory position
+ *
+ * @return false if the target is unknown
+ */
+bool read(Machine& machine, const std::string& target, uint16_t& value)
+{
+	if(isAddress(target))
+	{
+		value = machine.peek(addressOf(target));
+		return true;
+	}
+
+	int high;
+	Register* reg = findRegister(machine, target, high);
+	if(reg == nullptr)
+		return false;
+
+	value = high < 0 ? reg->value : (high ? reg->bytes.H : reg->bytes.L);
+	return true;
+}
+
+/**
+ * @brief Run one test case on a new machine of the given engine
+ *
+ * @return description of every mismatch (empty if the test passed)
+ */
+std::string run(const Engine& engine, const TestCase& test)
+{
+	std::unique_ptr<Machine> machine(engine.create());
+	for(auto& assignment : test.initial)
+		apply(*machine, assignment);
+	for(size_t i = 0; i < test.opcodes.size(); i++)
+		machine->poke(i, test.opcodes[i]);
+
+	machine->execute();
+
+	std::ostringstream errors;
+	if(*machine->clockCycles != test.cycles)
+		errors << "  cycles: expected " << test.cycles << ", got " << *machine->clockCycles << "\n";
+
+	for(auto& assignment : test.expected)
+	{
+		uint16_t value;
+		if(!read(*machine, assignment.target, value))
+			errors << "  unknown target " << assignment.target << "\n";
+		else if(value != assignment.value)
+			errors << "  " << assignment.target << ": expected 0x" << std::hex << assignment.value
+				   << ", got 0x" << value << std::dec << "\n";
+	}
+
+	return errors.str();
+}
+
+} // namespace
+
+//-------------------------------------------------------------------------
+// Tests
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+void PrintTo(const Engine& engine, std::ostream* os)
+{
+	*os << engine.name;
+}
+
+} // namespace emuzeta80
+
+class EmuZeta80CSVTest : public ::testing::TestWithParam<Engine>
+{
+};
+
+TEST_P(EmuZeta80CSVTest, AllOpcodes)
+{
+	const auto& cases = testCases();
+	ASSERT_FALSE(cases.empty()) << "cannot load " << EMUZETA80_TESTS_CSV;
+
+	std::vector<std::string> results(cases.size());
+	std::atomic<size_t> next(0);
+
+	auto worker = [&]() {
+		for(size_t i = next++; i < cases.size(); i = next++)
+			results[i] = run(GetParam(), cases[i]);
+	};
+
+	unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::thread> threads;
+	for(unsigned i = 0; i < threadCount; i++)
+		threads.emplace_back(worker);
+	for(auto& thread : threads)
+		thread.join();
+
+	for(size_t i = 0; i < cases.size(); i++)
+		EXPECT_TRUE(results[i].empty()) << cases[i].name << " (" << GetParam().name << ")\n" << results[i];
+}
+
+INSTANTIATE_TEST_SUITE_P(Engines, EmuZeta80CSVTest, ::testing::ValuesIn(engines()),
+						 [](const ::testing::TestParamInfo<Engine>& info) { return std::string(info.param.name); });
@@ -0,0 +1,46 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file emuzeta80_debugger_program.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Guest program shared by the Debugger and GdbServer tests
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CPU.h"
+
+// 0000: LD HL, 4000h / LD DE, 5000h / LD BC, 0010h / LDIR
+// 000B: LD A, (4008h) / INC A / LD (6000h), A / JP 000Bh
+const std::vector<uint8_t> DEBUGGER_PROGRAM = {0x21, 0x00, 0x40, 0x11, 0x00, 0x50, 0x01, 0x10, 0x00, 0xED, 0xB0,
+                                               0x3A, 0x08, 0x40, 0x3C, 0x32, 0x00, 0x60, 0xC3, 0x0B, 0x00};
+
+/**
+ * @brief Load the program at 0000h and the bytes 01h-10h at 4000h
+ */
+inline void loadDebuggerProgram(emuzeta80::CPU& cpu)
+{
+	cpu.memory->load(0, DEBUGGER_PROGRAM.data(), DEBUGGER_PROGRAM.size());
+	for(uint16_t i = 0; i < 0x10; i++)
+		cpu.memory->poke(0x4000 + i, i + 1);
+}
@@ -0,0 +1,107 @@
+#include "Debugger.h"
+#include "emuzeta80_debugger_program.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace emuzeta80;
+
+TEST(EmuZeta80DebuggerTest, BREAKPOINTS)
+{
+	CPU cpu(0x10000);
+	loadDebuggerProgram(cpu);
+
+	Debugger debugger(&cpu);
+	debugger.addBreakpoint(0x000E);
+	ASSERT_TRUE(debugger.hasBreakpoint(0x000E));
+	ASSERT_FALSE(debugger.hasBreakpoint(0x000F));
+
+	// LD HL / LD DE / LD BC / LDIR (16 iterations) / LD A, (4008h)
+	ASSERT_EQ(debugger.run(100000), 20u);
+	ASSERT_EQ(debugger.getStopReason(), Debugger::STOP_BREAKPOINT);
+	ASSERT_EQ(debugger.getStopAddress(), 0x000E);
+	ASSERT_EQ(cpu.pc.value, 0x000E);
+	ASSERT_EQ(cpu.memory->peek(0x500F), 0x10);
+
+	// Resumed from the breakpoint: one turn of the loop
+	ASSERT_EQ(debugger.run(100000), 4u);
+	ASSERT_EQ(cpu.pc.value, 0x000E);
+	ASSERT_EQ(cpu.memory->peek(0x6000), 0x0A);
+
+	debugger.removeBreakpoint(0x000E);
+	debugger.run(1000);
+	ASSERT_EQ(debugger.getStopReason(), Debugger::STOP_NONE);
+}
+
+TEST(EmuZeta80DebuggerTest, WATCHPOINTS)
+{
+	CPU cpu(0x10000);
+	loadDebuggerProgram(cpu);
+
+	// Only the last byte of the block is watched (the page is read from the start)
+	Debugger debugger(&cpu);
+	debugger.addWatchpoint(0x400F, 1, true, false);
+	debugger.addWatchpoint(0x6000, 2, false, true);
+
+	// The LDIR stops after the iteration that reads 400Fh
+	ASSERT_EQ(debugger.run(100000), 19u);
+	ASSERT_EQ(debugger.getStopReason(), Debugger::STOP_READ);
+	ASSERT_EQ(debugger.getStopAddress(), 0x400F);
+	ASSERT_EQ(cpu.pc.value, 0x000B);
+	ASSERT_EQ(cpu.getde(), 0x5010);
+
+	// LD A, (4008h) / INC A / LD (6000h), A
+	ASSERT_EQ(debugger.run(100000), 3u);
+	ASSERT_EQ(debugger.getStopReason(), Debugger::STOP_WRITE);
+	ASSERT_EQ(debugger.getStopAddress(), 0x6000);
+	ASSERT_EQ(cpu.pc.value, 0x0012);
+
+	// Host accesses are not reported after the watchpoints are removed
+	debugger.removeWatchpoint(0x6000, 2);
+	debugger.run(1000);
+	ASSERT_EQ(debugger.getStopReason(), Debugger::STOP_NONE);
+	debugger.clear();
+	cpu.memory->peek(0x400F);
+	ASSERT_EQ(debugger.getStopReason(), Debugger::STOP_NONE);
+}
+
+TEST(EmuZeta80DebuggerTest, FETCHES_ARE_NOT_READS)
+{
+	CPU cpu(0x10000);
+	loadDebuggerProgram(cpu);
+
+	// Opcodes and operands of the watched program are not data reads
+	Debugger debugger(&cpu);
+	debugger.addWatchpoint(0x0000, DEBUGGER_PROGRAM.size(), true, false);
+	debugger.run(1000);
+	ASSERT_EQ(debugger.getStopReason(), Debugger::STOP_NONE);
+
+	// LD A, (0013h) reads the operand of the JP as data
+	cpu.memory->poke(0x000C, 0x13);
+	cpu.memory->poke(0x000D, 0x00);
+	debugger.run(1000);
+	ASSERT_EQ(debugger.getStopReason(), Debugger::STOP_READ);
+	ASSERT_EQ(debugger.getStopAddress(), 0x0013);
+	ASSERT_EQ(cpu.pc.value, 0x000E);
+}
+
+TEST(EmuZeta80DebuggerTest, SAME_AS_RUN)
+{
+	CPU expected(0x10000), actual(0x10000);
+	loadDebuggerProgram(expected);
+	loadDebuggerProgram(actual);
+
+	// Breakpoints and watchpoints that are never hit
+	Debugger debugger(&actual);
+	for(uint16_t i = 0; i < 100; i++)
+		debugger.addBreakpoint(0x8000 + i * 7);
+	debugger.addWatchpoint(0x40F0, 1, true, true);
+
+	for(int slice = 0; slice < 20; slice++)
+	{
+		ASSERT_EQ(expected.run(333), debugger.run(333));
+		ASSERT_EQ(debugger.getStopReason(), Debugger::STOP_NONE);
+		ASSERT_EQ(expected.pc.value, actual.pc.value);
+		ASSERT_EQ(expected.clockCycles, actual.clockCycles);
+		ASSERT_EQ(expected.getaf(), actual.getaf());
+	}
+}
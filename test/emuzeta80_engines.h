@@ -0,0 +1,137 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file emuzeta80_engines.h
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Registry of execution engines shared by the test runners
+ *
+ * Every engine registered in engines() is exercised by the CSV runner and the
+ * differential fuzzer. The first engine is the reference (CPU::execute).
+ * Engines that fuse instructions may execute two of them in one step.
+ *
+ */
+
+#pragma once
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <cstdint>
+#include <vector>
+
+#include "CPU.h"
+#include "Fusion.h"
+
+//-------------------------------------------------------------------------
+// Class definition
+//-------------------------------------------------------------------------
+
+namespace emuzeta80
+{
+
+/**
+ * @brief Engine independent view of one emulator instance
+ */
+class Machine
+{
+public:
+    virtual ~Machine() { }
+
+    // Execute the next instruction (or fused pair), returns the number of instructions
+    virtual unsigned execute() = 0;
+    virtual uint8_t peek(uint16_t address) = 0;
+    virtual void poke(uint16_t address, uint8_t value) = 0;
+
+    RegistersBank* mainBank;
+    RegistersBank* alternateBank;
+    Register* pc;
+    Register* sp;
+    Register* iX;
+    Register* iY;
+    uint64_t* clockCycles;
+};
+
+/**
+ * @brief Machine backed by any class with the public interface of CPU
+ */
+template<class T>
+class MachineOf : public Machine
+{
+public:
+    MachineOf() : cpu(0x10000)
+    {
+        mainBank = &cpu.mainBank;
+        alternateBank = &cpu.alternateBank;
+        pc = &cpu.pc;
+        sp = &cpu.sp;
+        iX = &cpu.iX;
+        iY = &cpu.iY;
+        clockCycles = &cpu.clockCycles;
+    }
+
+    unsigned execute() override
+    {
+        cpu.execute();
+        return 1;
+    }
+    uint8_t peek(uint16_t address) override { return cpu.memory->peek(address); }
+    void poke(uint16_t address, uint8_t value) override { cpu.memory->poke(address, value); }
+
+    T cpu;
+};
+
+/**
+ * @brief Machine running every supported instruction pair with Fusion
+ */
+class FusionMachine : public MachineOf<CPU>
+{
+public:
+    FusionMachine() : fusion(&cpu)
+    {
+        for(unsigned pair = 0; pair < 0x10000; pair++)
+            fusion.enable(pair >> 8, pair & 0xFF);
+    }
+
+    unsigned execute() override { return fusion.step(); }
+
+    Fusion fusion;
+};
+
+struct Engine
+{
+    const char* name;
+    Machine* (*create)();
+};
+
+/**
+ * @brief List of execution engines, the reference engine first
+ */
+inline const std::vector<Engine>& engines()
+{
+    static const std::vector<Engine> list = {
+        {"switch", []() -> Machine* { return new MachineOf<CPU>(); }},
+        {"fixed", []() -> Machine* { return new MachineOf<FixedCPU<>>(); }},
+        {"fusion", []() -> Machine* { return new FusionMachine(); }},
+    };
+
+    return list;
+}
+
+} // namespace emuzeta80
@@ -0,0 +1,95 @@
+#include "Farm.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace emuzeta80;
+
+namespace
+{
+
+// Sum of the 16 bytes at 8000h stored at 9000h, then loop forever
+const std::vector<uint8_t> SUM_PROGRAM = {
+	0x21, 0x00, 0x80, // 0000: LD HL, 8000h
+	0x06, 0x10,       // 0003: LD B, 16
+	0xAF,             // 0005: XOR A
+	0x86,             // 0006: ADD A, (HL)
+	0x23,             // 0007: INC HL
+	0x05,             // 0008: DEC B
+	0xC2, 0x06, 0x00, // 0009: JP NZ, 0006h
+	0x32, 0x00, 0x90, // 000C: LD (9000h), A
+	0xC3, 0x0F, 0x00  // 000F: JP 000Fh
+};
+
+} // namespace
+
+TEST(EmuZeta80FarmTest, JOBS_MATCH_SEQUENTIAL_RUN)
+{
+	const size_t count = 1000;
+	Farm farm(SUM_PROGRAM.data(), SUM_PROGRAM.size(), 0, 4);
+
+	std::vector<uint8_t> inputs(count * 16);
+	std::vector<uint8_t> outputs(count);
+	std::vector<FarmJob> jobs(count);
+	std::vector<FarmResult> results(count);
+
+	for(size_t i = 0; i < count; i++)
+	{
+		for(size_t j = 0; j < 16; j++)
+			inputs[i * 16 + j] = (uint8_t)(i * 7 + j * 13);
+
+		jobs[i].input = &inputs[i * 16];
+		jobs[i].inputAddress = 0x8000;
+		jobs[i].inputSize = 16;
+		jobs[i].cycles = 1000 + i;
+		jobs[i].output = &outputs[i];
+		jobs[i].outputAddress = 0x9000;
+		jobs[i].outputSize = 1;
+	}
+
+	farm.run(jobs.data(), results.data(), count);
+
+	CPU cpu(0x10000);
+	for(size_t i = 0; i < count; i++)
+	{
+		uint8_t sum = 0;
+		for(size_t j = 0; j < 16; j++)
+			sum += inputs[i * 16 + j];
+		ASSERT_EQ(outputs[i], sum);
+
+		cpu.memory->load(0, std::vector<uint8_t>(0x10000, 0).data(), 0x10000);
+		cpu.memory->load(0, SUM_PROGRAM.data(), SUM_PROGRAM.size());
+		cpu.memory->load(0x8000, &inputs[i * 16], 16);
+		cpu.restore(jobs[i].initial);
+		ASSERT_EQ(results[i].instructions, cpu.run(jobs[i].cycles));
+		ASSERT_EQ(results[i].state.clockCycles, cpu.clockCycles);
+		ASSERT_EQ(results[i].state.pc.value, cpu.pc.value);
+		ASSERT_EQ(results[i].state.mainBank.af.value, cpu.mainBank.af.value);
+		ASSERT_EQ(results[i].state.mainBank.hl.value, cpu.mainBank.hl.value);
+	}
+}
+
+TEST(EmuZeta80FarmTest, REUSE_BETWEEN_BATCHES)
+{
+	Farm farm(SUM_PROGRAM.data(), SUM_PROGRAM.size());
+
+	uint8_t input[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+	uint8_t output = 0;
+	FarmJob job;
+	job.input = input;
+	job.inputAddress = 0x8000;
+	job.inputSize = 16;
+	job.cycles = 1000;
+	job.output = &output;
+	job.outputAddress = 0x9000;
+	job.outputSize = 1;
+
+	for(int batch = 0; batch < 3; batch++)
+	{
+		FarmResult result;
+		output = 0;
+		farm.run(&job, &result, 1);
+
+		ASSERT_EQ(output, 136);
+		ASSERT_GE(result.state.clockCycles, 1000u);
+	}
+}
@@ -0,0 +1,168 @@
+#include "Fusion.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace emuzeta80;
+
+namespace
+{
+
+// 0000: LD HL, 4000h / LD DE, 5000h / LD B, 40h
+// 0008: LD A, (HL) / INC HL / CP 07h / JR Z, 0010h / LD (DE), A / INC DE
+// 0010: PUSH BC / PUSH HL / POP HL / POP BC / DEC B / JP NZ, 0008h / JP 0000h
+const std::vector<uint8_t> COPY_PROGRAM = {0x21, 0x00, 0x40, 0x11, 0x00, 0x50, 0x06, 0x40,
+                                           0x7E, 0x23, 0xFE, 0x07, 0x28, 0x02, 0x12, 0x13,
+                                           0xC5, 0xE5, 0xE1, 0xC1, 0x05, 0xC2, 0x08, 0x00,
+                                           0xC3, 0x00, 0x00};
+
+void load(CPU& cpu)
+{
+	cpu.memory->load(0, COPY_PROGRAM.data(), COPY_PROGRAM.size());
+	for(uint16_t i = 0; i < 0x40; i++)
+		cpu.memory->poke(0x4000 + i, (i * 37) % 11);
+	cpu.sp.value = 0xF000;
+}
+
+void compare(CPU& expected, CPU& actual)
+{
+	ASSERT_EQ(expected.pc.value, actual.pc.value);
+	ASSERT_EQ(expected.sp.value, actual.sp.value);
+	ASSERT_EQ(expected.getaf(), actual.getaf());
+	ASSERT_EQ(expected.getbc(), actual.getbc());
+	ASSERT_EQ(expected.getde(), actual.getde());
+	ASSERT_EQ(expected.gethl(), actual.gethl());
+	ASSERT_EQ(expected.clockCycles, actual.clockCycles);
+	ASSERT_EQ(expected.getr(), actual.getr());
+	for(uint16_t address = 0x5000; address < 0x5040; address++)
+		ASSERT_EQ(expected.memory->peek(address), actual.memory->peek(address));
+	for(uint16_t address = 0xEFF0; address < 0xF000; address++)
+		ASSERT_EQ(expected.memory->peek(address), actual.memory->peek(address));
+}
+
+} // namespace
+
+TEST(EmuZeta80FusionTest, SUPPORTED_PAIRS)
+{
+	ASSERT_TRUE(Fusion::isSupported(0x7E, 0x23));  // LD A,(HL) / INC HL
+	ASSERT_TRUE(Fusion::isSupported(0x05, 0x20));  // DEC B / JR NZ
+	ASSERT_TRUE(Fusion::isSupported(0xFE, 0x28));  // CP n / JR Z
+	ASSERT_TRUE(Fusion::isSupported(0xF5, 0xC5));  // PUSH AF / PUSH BC
+	ASSERT_TRUE(Fusion::isSupported(0xE1, 0xD1));  // POP HL / POP DE
+	ASSERT_FALSE(Fusion::isSupported(0x7E, 0x13)); // LD A,(HL) / INC DE
+	ASSERT_FALSE(Fusion::isSupported(0x35, 0x20)); // DEC (HL) / JR NZ
+	ASSERT_FALSE(Fusion::isSupported(0x00, 0x00));
+
+	CPU cpu(0x10000);
+	Fusion fusion(&cpu);
+	ASSERT_FALSE(fusion.enable(0x00, 0x00));
+	ASSERT_TRUE(fusion.enable(0x7E, 0x23));
+	ASSERT_TRUE(fusion.isEnabled(0x7E, 0x23));
+	fusion.disable();
+	ASSERT_FALSE(fusion.isEnabled(0x7E, 0x23));
+}
+
+TEST(EmuZeta80FusionTest, PROFILE_AND_CONFIGURE)
+{
+	CPU cpu(0x10000);
+	load(cpu);
+
+	Fusion fusion(&cpu);
+	fusion.profile(20000);
+	ASSERT_GT(fusion.getCount(0x7E, 0x23), 0u);
+	ASSERT_GT(fusion.getCount(0x05, 0xC2), 0u);
+	ASSERT_EQ(fusion.getCount(0x23, 0x7E), 0u);
+
+	// PUSH BC / PUSH HL, POP HL / POP BC, DEC B / JP NZ, LD A,(HL) / INC HL, CP n / JR Z and LD (DE),A / INC DE
+	ASSERT_EQ(fusion.configure(1), 1u);
+	ASSERT_EQ(fusion.configure(16), 6u);
+	ASSERT_TRUE(fusion.isEnabled(0x12, 0x13));
+	ASSERT_TRUE(fusion.isEnabled(0xC5, 0xE5));
+
+	fusion.clearProfile();
+	ASSERT_EQ(fusion.getCount(0x7E, 0x23), 0u);
+	ASSERT_EQ(fusion.configure(16), 0u);
+}
+
+TEST(EmuZeta80FusionTest, SAME_AS_RUN)
+{
+	// Budgets that end between the two instructions of the pairs
+	for(uint64_t cycles = 1; cycles < 400; cycles += 7)
+	{
+		CPU expected(0x10000), actual(0x10000);
+		load(expected);
+		load(actual);
+
+		Fusion fusion(&actual);
+		for(unsigned pair = 0; pair < 0x10000; pair++)
+			fusion.enable(pair >> 8, pair & 0xFF);
+
+		uint64_t instructions = 0, fused = 0;
+		for(int slice = 0; slice < 20; slice++)
+		{
+			instructions += expected.run(cycles);
+			fused += fusion.run(cycles);
+			ASSERT_EQ(instructions, fused);
+			compare(expected, actual);
+		}
+	}
+}
+
+TEST(EmuZeta80FusionTest, INTERRUPTS)
+{
+	CPU expected(0x10000), actual(0x10000);
+	for(CPU* cpu : {&expected, &actual})
+	{
+		load(*cpu);
+		// 0038: EI / RET (IM 1)
+		cpu->memory->poke(0x0038, 0xFB);
+		cpu->memory->poke(0x0039, 0xC9);
+		cpu->iff1 = cpu->iff2 = true;
+		cpu->im = 1;
+	}
+
+	Fusion fusion(&actual);
+	for(unsigned pair = 0; pair < 0x10000; pair++)
+		fusion.enable(pair >> 8, pair & 0xFF);
+
+	for(int frame = 0; frame < 50; frame++)
+	{
+		expected.interrupt();
+		actual.interrupt();
+		ASSERT_EQ(expected.run(333), fusion.run(333));
+		compare(expected, actual);
+	}
+}
+
+TEST(EmuZeta80FusionTest, SELF_MODIFYING_PAIRS)
+{
+	// 0000: LD (HL), A over the INC HL that follows it / JR $
+	// 8000: PUSH BC / PUSH DE with the stack over the second PUSH / NOP / JR $
+	CPU expected(0x10000), actual(0x10000);
+	for(CPU* cpu : {&expected, &actual})
+	{
+		const uint8_t store[] = {0x77, 0x23, 0x18, 0xFE};
+		const uint8_t push[] = {0xC5, 0xD5, 0x00, 0x18, 0xFE};
+		cpu->memory->load(0x0000, store, sizeof(store));
+		cpu->memory->load(0x8000, push, sizeof(push));
+		cpu->mainBank.hl.value = 0x0001;
+		cpu->mainBank.af.bytes.H = 0x00;
+	}
+
+	Fusion fusion(&actual);
+	fusion.enable(0x77, 0x23);
+	fusion.enable(0xC5, 0xD5);
+
+	ASSERT_EQ(expected.run(30), fusion.run(30));
+	compare(expected, actual);
+	ASSERT_EQ(actual.gethl(), 0x0001);
+
+	for(CPU* cpu : {&expected, &actual})
+	{
+		cpu->pc.value = 0x8000;
+		cpu->sp.value = 0x8003;
+		cpu->mainBank.bc.value = 0x0000;
+	}
+	ASSERT_EQ(expected.run(40), fusion.run(40));
+	compare(expected, actual);
+	ASSERT_EQ(actual.sp.value, 0x8001);
+}
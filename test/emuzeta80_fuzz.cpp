@@ -0,0 +1,316 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file emuzeta80_fuzz.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Differential fuzzer between the execution engines
+ *
+ * An input is decoded as an initial register state followed by instruction
+ * bytes loaded at 0000h. The input runs on the reference engine and on every
+ * registered engine (the reference included, as a determinism check) and
+ * the states are compared after every instruction: main and alternate banks,
+ * PC, SP, IX, IY, clock cycles and the whole memory at the end.
+ *
+ * Built with EMUZETA80_LIBFUZZER the file provides LLVMFuzzerTestOneInput and
+ * aborts on divergence (libFuzzer minimizes the crash input itself). Otherwise
+ * it is a standalone program:
+ *
+ *   emuzeta80_fuzz [iterations] [seed]
+ *
+ * that generates random inputs and minimizes the first diverging one.
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "emuzeta80_engines.h"
+
+using namespace emuzeta80;
+
+//-------------------------------------------------------------------------
+// Differential execution
+//-------------------------------------------------------------------------
+
+namespace
+{
+
+const size_t STATE_SIZE = 22; //< af, bc, de, hl, af', bc', de', hl', ix, iy, sp
+const size_t MAX_CODE = 64;   //< maximum number of instruction bytes
+const size_t MAX_STEPS = 32;  //< maximum number of executed instructions
+
+/**
+ * @brief Load the register state and the instruction bytes of an input
+ */
+void setup(Machine& machine, const uint8_t* data, size_t size)
+{
+    uint8_t state[STATE_SIZE] = {};
+    for(size_t i = 0; i < STATE_SIZE && i < size; i++)
+        state[i] = data[i];
+
+    Register* registers[] = {
+        &machine.mainBank->af, &machine.mainBank->bc, &machine.mainBank->de, &machine.mainBank->hl,
+        &machine.alternateBank->af, &machine.alternateBank->bc, &machine.alternateBank->de, &machine.alternateBank->hl,
+        machine.iX, machine.iY, machine.sp,
+    };
+    for(size_t i = 0; i < sizeof(registers) / sizeof(registers[0]); i++)
+        registers[i]->value = state[2 * i] + (state[2 * i + 1] << 8);
+
+    machine.pc->value = 0;
+    for(size_t i = STATE_SIZE; i < size && i - STATE_SIZE < MAX_CODE; i++)
+        machine.poke(i - STATE_SIZE, data[i]);
+}
+
+/**
+ * @brief Compare the state of two machines
+ *
+ * @return description of the first difference (empty if equal)
+ */
+std::string compare(Machine& a, Machine& b, bool memory)
+{
+    char text[128];
+    const struct
+    {
+        const char* name;
+        uint16_t a, b;
+    } registers[] = {
+        {"af", a.mainBank->af.value, b.mainBank->af.value},
+        {"bc", a.mainBank->bc.value, b.mainBank->bc.value},
+        {"de", a.mainBank->de.value, b.mainBank->de.value},
+        {"hl", a.mainBank->hl.value, b.mainBank->hl.value},
+        {"af'", a.alternateBank->af.value, b.alternateBank->af.value},
+        {"bc'", a.alternateBank->bc.value, b.alternateBank->bc.value},
+        {"de'", a.alternateBank->de.value, b.alternateBank->de.value},
+        {"hl'", a.alternateBank->hl.value, b.alternateBank->hl.value},
+        {"pc", a.pc->value, b.pc->value},
+        {"sp", a.sp->value, b.sp->value},
+        {"ix", a.iX->value, b.iX->value},
+        {"iy", a.iY->value, b.iY->value},
+    };
+
+    for(auto& reg : registers)
+    {
+        if(reg.a != reg.b)
+        {
+            std::snprintf(text, sizeof(text), "%s: %04X != %04X", reg.name, reg.a, reg.b);
+            return text;
+        }
+    }
+
+    if(*a.clockCycles != *b.clockCycles)
+    {
+        std::snprintf(text, sizeof(text), "clockCycles: %llu != %llu",
+                      (unsigned long long)*a.clockCycles, (unsigned long long)*b.clockCycles);
+        return text;
+    }
+
+    if(memory)
+    {
+        for(uint32_t address = 0; address < 0x10000; address++)
+        {
+            uint8_t valueA = a.peek(address);
+            uint8_t valueB = b.peek(address);
+            if(valueA != valueB)
+            {
+                std::snprintf(text, sizeof(text), "[%04X]: %02X != %02X", address, valueA, valueB);
+                return text;
+            }
+        }
+    }
+
+    return "";
+}
+
+/**
+ * @brief Run an input on the reference engine and on the given engine
+ *
+ * @return description of the divergence (empty if both engines agree)
+ */
+std::string diverge(const Engine& engine, const uint8_t* data, size_t size)
+{
+    std::unique_ptr<Machine> reference(engines()[0].create());
+    std::unique_ptr<Machine> machine(engine.create());
+    setup(*reference, data, size);
+    setup(*machine, data, size);
+
+    for(size_t step = 0; step < MAX_STEPS; step++)
+    {
+        // The reference catches up with engines that fuse instructions
+        unsigned instructions = machine->execute();
+        for(unsigned i = 0; i < instructions; i++)
+            reference->execute();
+
+        auto difference = compare(*reference, *machine, false);
+        if(!difference.empty())
+            return "step " + std::to_string(step) + ": " + difference;
+    }
+
+    return compare(*reference, *machine, true);
+}
+
+/**
+ * @brief Run an input on every engine
+ *
+ * @param engineName set to the name of the first diverging engine
+ * @return description of the divergence (empty if all engines agree)
+ */
+std::string diverge(const uint8_t* data, size_t size, const char** engineName = nullptr)
+{
+    for(auto& engine : engines())
+    {
+        auto difference = diverge(engine, data, size);
+        if(!difference.empty())
+        {
+            if(engineName != nullptr)
+                *engineName = engine.name;
+            return difference;
+        }
+    }
+
+    return "";
+}
+
+} // namespace
+
+//-------------------------------------------------------------------------
+// libFuzzer entry point
+//-------------------------------------------------------------------------
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const char* engineName = "";
+    auto difference = diverge(data, size, &engineName);
+    if(!difference.empty())
+    {
+        std::fprintf(stderr, "engine %s diverges from %s: %s\n", engineName, engines()[0].name, difference.c_str());
+        std::abort();
+    }
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+// Standalone fuzzer
+//-------------------------------------------------------------------------
+
+#ifndef EMUZETA80_LIBFUZZER
+
+namespace
+{
+
+bool diverges(const std::vector<uint8_t>& input)
+{
+    return !diverge(input.data(), input.size()).empty();
+}
+
+/**
+ * @brief Shrink a diverging input while it keeps diverging
+ *
+ * Instruction bytes are removed in chunks of decreasing size, then every
+ * remaining byte (register state included) is cleared if possible.
+ */
+std::vector<uint8_t> minimize(std::vector<uint8_t> input)
+{
+    for(size_t chunk = (input.size() - STATE_SIZE) / 2; chunk > 0; chunk /= 2)
+    {
+        for(size_t start = STATE_SIZE; start + chunk <= input.size();)
+        {
+            std::vector<uint8_t> candidate(input);
+            candidate.erase(candidate.begin() + start, candidate.begin() + start + chunk);
+            if(diverges(candidate))
+                input = candidate;
+            else
+                start += chunk;
+        }
+    }
+
+    for(size_t i = 0; i < input.size(); i++)
+    {
+        if(input[i] == 0)
+            continue;
+
+        std::vector<uint8_t> candidate(input);
+        candidate[i] = 0;
+        if(diverges(candidate))
+            input = candidate;
+    }
+
+    return input;
+}
+
+void print(const std::vector<uint8_t>& input)
+{
+    std::printf("  state:");
+    for(size_t i = 0; i < STATE_SIZE; i++)
+        std::printf(" %02X", input[i]);
+    std::printf("\n  code: ");
+    for(size_t i = STATE_SIZE; i < input.size(); i++)
+        std::printf(" %02X", input[i]);
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 10000;
+    uint32_t seed = argc > 2 ? (uint32_t)std::strtoul(argv[2], nullptr, 0) : std::random_device()();
+
+    std::printf("fuzzing %zu engine(s) against %s: %llu iterations, seed %u\n", engines().size(),
+                engines()[0].name, (unsigned long long)iterations, seed);
+
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> byte(0, 0xFF);
+    std::uniform_int_distribution<size_t> length(1, MAX_CODE);
+
+    for(uint64_t iteration = 0; iteration < iterations; iteration++)
+    {
+        std::vector<uint8_t> input(STATE_SIZE + length(random));
+        for(auto& value : input)
+            value = (uint8_t)byte(random);
+
+        const char* engineName = "";
+        auto difference = diverge(input.data(), input.size(), &engineName);
+        if(difference.empty())
+            continue;
+
+        std::printf("iteration %llu: engine %s diverges: %s\n", (unsigned long long)iteration, engineName,
+                    difference.c_str());
+        print(input);
+
+        auto minimized = minimize(input);
+        std::printf("minimized: %s\n", diverge(minimized.data(), minimized.size()).c_str());
+        print(minimized);
+
+        return 1;
+    }
+
+    std::printf("no divergence found\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,141 @@
+#include "GdbServer.h"
+#include "emuzeta80_debugger_program.h"
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "gtest/gtest.h"
+
+using namespace emuzeta80;
+
+namespace
+{
+
+// Client side of the protocol: send a packet and return the reply
+std::string exchange(int socket, const std::string& packet)
+{
+	uint8_t sum = 0;
+	for(char c : packet)
+		sum += (uint8_t)c;
+
+	char checksum[3];
+	snprintf(checksum, sizeof(checksum), "%02x", sum);
+	std::string frame = "$" + packet + "#" + checksum;
+	if(send(socket, frame.data(), frame.size(), MSG_NOSIGNAL) != (ssize_t)frame.size())
+		return "error";
+
+	std::string reply;
+	char c;
+	bool inside = false;
+	while(read(socket, &c, 1) == 1)
+	{
+		if(!inside)
+		{
+			inside = c == '$';
+			continue;
+		}
+		if(c == '#')
+		{
+			char checksum[2];
+			// The server may close the socket after the reply (D, k)
+			if(read(socket, checksum, 2) != 2)
+				return "error";
+			send(socket, "+", 1, MSG_NOSIGNAL);
+			return reply;
+		}
+		reply += c;
+	}
+
+	return "error";
+}
+
+} // namespace
+
+TEST(EmuZeta80GdbTest, REGISTERS_AND_MEMORY)
+{
+	CPU cpu(0x10000);
+	GdbServer server(&cpu);
+	cpu.mainBank.af.value = 0x1234;
+	cpu.pc.value = 0xABCD;
+	cpu.i = 0x56;
+
+	std::string registers = server.handle("g");
+	ASSERT_EQ(registers.size(), 13u * 4);
+	ASSERT_EQ(registers.substr(0, 4), "3412");
+	ASSERT_EQ(registers.substr(5 * 4, 4), "cdab");
+	ASSERT_EQ(registers.substr(12 * 4, 4), "0056");
+
+	ASSERT_EQ(server.handle("P1=7856"), "OK");
+	ASSERT_EQ(cpu.getbc(), 0x5678);
+	ASSERT_EQ(server.handle("p1"), "7856");
+	ASSERT_EQ(server.handle("pd"), "E01");
+
+	registers[4 * 4] = 'f';
+	ASSERT_EQ(server.handle("G" + registers), "OK");
+	ASSERT_EQ(cpu.sp.value, 0x00F0);
+	ASSERT_EQ(cpu.getbc(), 0x0000);
+
+	// Memory writes patch ROM regions too
+	cpu.memory->protect(0x0000, 0x100);
+	ASSERT_EQ(server.handle("M10,3:0a0b0c"), "OK");
+	ASSERT_EQ(server.handle("m10,4"), "0a0b0c00");
+
+	// Invalid hex digits are rejected without writing anything
+	ASSERT_EQ(server.handle("M10,2:zz0d"), "E01");
+	ASSERT_EQ(server.handle("m10,2"), "0a0b");
+	ASSERT_EQ(server.handle("vMustReplyEmpty"), "");
+}
+
+TEST(EmuZeta80GdbTest, BREAKPOINTS_AND_WATCHPOINTS)
+{
+	CPU cpu(0x10000);
+	loadDebuggerProgram(cpu);
+	GdbServer server(&cpu);
+
+	ASSERT_EQ(server.handle("?"), "S05");
+	ASSERT_EQ(server.handle("Z0,e,1"), "OK");
+	ASSERT_EQ(server.handle("c"), "S05");
+	ASSERT_EQ(cpu.pc.value, 0x000E);
+
+	ASSERT_EQ(server.handle("s"), "S05");
+	ASSERT_EQ(cpu.pc.value, 0x000F);
+
+	ASSERT_EQ(server.handle("z0,e,1"), "OK");
+	ASSERT_EQ(server.handle("Z2,6000,1"), "OK");
+	ASSERT_EQ(server.handle("c"), "T05watch:6000;");
+	ASSERT_EQ(cpu.pc.value, 0x0012);
+	ASSERT_EQ(server.handle("z2,6000,1"), "OK");
+
+	ASSERT_EQ(server.handle("Z3,4008,1"), "OK");
+	ASSERT_EQ(server.handle("c"), "T05rwatch:4008;");
+	ASSERT_EQ(cpu.pc.value, 0x000E);
+}
+
+TEST(EmuZeta80GdbTest, UNIX_SOCKET)
+{
+	CPU cpu(0x10000);
+	loadDebuggerProgram(cpu);
+	GdbServer server(&cpu);
+
+	std::string path = "/tmp/emuzeta80_gdb_" + std::to_string(getpid());
+	ASSERT_TRUE(server.listen(path.c_str()));
+	std::thread thread([&server]() { server.serve(); });
+
+	int client = socket(AF_UNIX, SOCK_STREAM, 0);
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	snprintf(address.sun_path, sizeof(address.sun_path), "%s", path.c_str());
+	ASSERT_EQ(connect(client, (sockaddr*)&address, sizeof(address)), 0);
+
+	ASSERT_EQ(exchange(client, "qSupported:swbreak+"), "PacketSize=1000");
+	ASSERT_EQ(exchange(client, "Z0,12,1"), "OK");
+	ASSERT_EQ(exchange(client, "c"), "S05");
+	ASSERT_EQ(exchange(client, "p5"), "1200");
+	ASSERT_EQ(exchange(client, "m6000,1"), "0a");
+	ASSERT_EQ(exchange(client, "D"), "OK");
+
+	thread.join();
+	close(client);
+}
@@ -0,0 +1,175 @@
+#include "Lockstep.h"
+#include <memory>
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace emuzeta80;
+
+namespace
+{
+
+// Random instructions mixing lockstep operations (loads, ALU, INC/DEC, JP cc)
+// with instructions that fall back to the scalar CPUs (PUSH/POP, EX, LD (nn), A)
+std::vector<uint8_t> randomProgram(std::mt19937& random, size_t length)
+{
+	static const std::vector<uint8_t> single = {
+		0x00, 0x03, 0x0B, 0x13, 0x1B, 0x23, 0x2B, 0x04, 0x0C, 0x14, 0x1C, 0x24, 0x2C, 0x3C, 0x05, 0x0D,
+		0x15, 0x1D, 0x25, 0x2D, 0x3D, 0x41, 0x4A, 0x53, 0x5C, 0x67, 0x78, 0x7E, 0x70, 0x77, 0x46, 0x80,
+		0x81, 0x86, 0x88, 0x8E, 0x90, 0x96, 0x98, 0x9E, 0xA0, 0xA6, 0xA8, 0xAE, 0xB0, 0xB6, 0xB8, 0xBE,
+		0xC5, 0xC1, 0xD5, 0xD1, 0xEB, 0x08,
+	};
+	static const std::vector<uint8_t> immediate = {0x06, 0x0E, 0x16, 0x1E, 0x26, 0x2E, 0x3E, 0x36,
+	                                               0xC6, 0xCE, 0xD6, 0xDE, 0xE6, 0xFE};
+	static const std::vector<uint8_t> conditional = {0xC2, 0xCA, 0xD2, 0xDA, 0xE2, 0xEA, 0xF2, 0xFA};
+
+	std::uniform_int_distribution<int> byte(0, 0xFF);
+	std::uniform_int_distribution<int> kind(0, 9);
+	std::vector<uint8_t> program;
+
+	while(program.size() < length)
+	{
+		int k = kind(random);
+		if(k < 6)
+		{
+			program.push_back(single[byte(random) % single.size()]);
+		}
+		else if(k < 8)
+		{
+			program.push_back(immediate[byte(random) % immediate.size()]);
+			program.push_back((uint8_t)byte(random));
+		}
+		else if(k < 9)
+		{
+			// LD HL, 8000h-80FFh keeps the (HL) accesses away from the code
+			program.push_back(0x21);
+			program.push_back((uint8_t)byte(random));
+			program.push_back(0x80);
+		}
+		else
+		{
+			// Forward conditional jump to the next instruction boundary or further
+			program.push_back(conditional[byte(random) % conditional.size()]);
+			program.push_back((uint8_t)(program.size() + 2 + byte(random) % 4));
+			program.push_back(0x00);
+			for(int i = 0; i < 3; i++)
+				program.push_back(0x00);
+		}
+	}
+
+	// JP 0000h
+	program.push_back(0xC3);
+	program.push_back(0x00);
+	program.push_back(0x00);
+
+	return program;
+}
+
+template<unsigned Lanes>
+void compareWithScalar(uint32_t seed, bool sameState)
+{
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int> word(0, 0xFFFF);
+	auto program = randomProgram(random, 200);
+
+	std::vector<std::unique_ptr<CPU>> lanes, scalars;
+	CPU* cpus[Lanes];
+	uint16_t state[5] = {};
+
+	for(unsigned lane = 0; lane < Lanes; lane++)
+	{
+		if(lane == 0 || !sameState)
+		{
+			for(auto& value : state)
+				value = (uint16_t)word(random);
+		}
+
+		for(int copy = 0; copy < 2; copy++)
+		{
+			std::unique_ptr<CPU> cpu(new CPU(0x10000));
+			cpu->memory->load(0, program.data(), program.size());
+			cpu->mainBank.af.value = state[0];
+			cpu->mainBank.bc.value = state[1];
+			cpu->mainBank.de.value = state[2];
+			cpu->mainBank.hl.value = 0x8000 | (state[3] & 0xFF);
+			cpu->sp.value = 0xF000 | (state[4] & 0x0FFF);
+			(copy == 0 ? lanes : scalars).push_back(std::move(cpu));
+		}
+
+		cpus[lane] = lanes.back().get();
+	}
+
+	Lockstep<Lanes> lockstep(cpus);
+	for(int slice = 0; slice < 4; slice++)
+	{
+		lockstep.run(2500);
+		for(auto& scalar : scalars)
+			scalar->run(2500);
+	}
+
+	for(unsigned lane = 0; lane < Lanes; lane++)
+	{
+		CPU& a = *lanes[lane];
+		CPU& b = *scalars[lane];
+		ASSERT_EQ(a.clockCycles, b.clockCycles) << "lane " << lane;
+		ASSERT_EQ(a.pc.value, b.pc.value) << "lane " << lane;
+		ASSERT_EQ(a.getr(), b.getr()) << "lane " << lane;
+		ASSERT_EQ(a.sp.value, b.sp.value) << "lane " << lane;
+		ASSERT_EQ(a.mainBank.af.value, b.mainBank.af.value) << "lane " << lane;
+		ASSERT_EQ(a.mainBank.bc.value, b.mainBank.bc.value) << "lane " << lane;
+		ASSERT_EQ(a.mainBank.de.value, b.mainBank.de.value) << "lane " << lane;
+		ASSERT_EQ(a.mainBank.hl.value, b.mainBank.hl.value) << "lane " << lane;
+		ASSERT_EQ(a.alternateBank.af.value, b.alternateBank.af.value) << "lane " << lane;
+		ASSERT_EQ(a.alternateBank.hl.value, b.alternateBank.hl.value) << "lane " << lane;
+
+		for(uint32_t address = 0; address < 0x10000; address++)
+			ASSERT_EQ(a.memory->peek(address), b.memory->peek(address)) << "lane " << lane << " [" << address << "]";
+	}
+
+	if(sameState)
+		ASSERT_EQ(lockstep.getGroupedLanes(), Lanes);
+}
+
+} // namespace
+
+TEST(EmuZeta80LockstepTest, SAME_STATE_STAYS_GROUPED)
+{
+	for(uint32_t seed = 0; seed < 8; seed++)
+		compareWithScalar<8>(seed, true);
+}
+
+TEST(EmuZeta80LockstepTest, DIVERGING_LANES_MATCH_SCALAR_8)
+{
+	for(uint32_t seed = 0; seed < 32; seed++)
+		compareWithScalar<8>(seed, false);
+}
+
+TEST(EmuZeta80LockstepTest, DIVERGING_LANES_MATCH_SCALAR_16)
+{
+	for(uint32_t seed = 0; seed < 16; seed++)
+		compareWithScalar<16>(seed, false);
+}
+
+TEST(EmuZeta80LockstepTest, VECTOR_INSTRUCTIONS)
+{
+	// LD B, 10h / ADD A, B / DEC B / JP NZ, 0002h / JP 0006h
+	const uint8_t program[] = {0x06, 0x10, 0x80, 0x05, 0xC2, 0x02, 0x00, 0xC3, 0x07, 0x00};
+
+	std::vector<std::unique_ptr<CPU>> lanes;
+	CPU* cpus[8];
+	for(unsigned lane = 0; lane < 8; lane++)
+	{
+		lanes.emplace_back(new CPU(0x10000));
+		lanes[lane]->memory->load(0, program, sizeof(program));
+		lanes[lane]->mainBank.af.bytes.H = lane;
+		cpus[lane] = lanes[lane].get();
+	}
+
+	Lockstep<8> lockstep(cpus);
+	lockstep.run(1000);
+
+	ASSERT_EQ(lockstep.getGroupedLanes(), 8u);
+	ASSERT_EQ(lockstep.getScalarInstructions(), 0u);
+	for(unsigned lane = 0; lane < 8; lane++)
+		ASSERT_EQ(lanes[lane]->mainBank.af.bytes.H, (uint8_t)(lane + 0x88));
+}
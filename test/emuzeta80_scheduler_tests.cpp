@@ -0,0 +1,102 @@
+#include "Scheduler.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace emuzeta80;
+
+namespace
+{
+
+struct Device
+{
+	CPU* cpu;
+	std::vector<uint64_t> scheduled; //< cycles received by the callback
+	std::vector<uint64_t> called;    //< clock cycles of the CPU at the calls
+
+	static void callback(void* context, uint64_t cycle)
+	{
+		Device* device = static_cast<Device*>(context);
+		device->scheduled.push_back(cycle);
+		device->called.push_back(device->cpu->clockCycles);
+	}
+};
+
+// JP 0000h
+const std::vector<uint8_t> LOOP_PROGRAM = {0xC3, 0x00, 0x00};
+
+} // namespace
+
+TEST(EmuZeta80SchedulerTest, EVENTS_IN_ORDER)
+{
+	CPU cpu(0x10000);
+	cpu.memory->load(0, LOOP_PROGRAM.data(), LOOP_PROGRAM.size());
+
+	Scheduler scheduler(&cpu);
+	Device device{&cpu};
+	const uint64_t cycles[] = {505, 95, 1000, 95, 333};
+	for(auto cycle : cycles)
+		ASSERT_GE(scheduler.schedule(cycle, &Device::callback, &device), 0);
+
+	ASSERT_EQ(scheduler.run(2000), 200u);
+	ASSERT_EQ(device.scheduled, std::vector<uint64_t>({95, 95, 333, 505, 1000}));
+
+	// Called after the instruction that reaches the cycle (JP takes 10 cycles)
+	for(size_t i = 0; i < device.called.size(); i++)
+	{
+		ASSERT_GE(device.called[i], device.scheduled[i]);
+		ASSERT_LT(device.called[i], device.scheduled[i] + 10);
+	}
+	ASSERT_EQ(scheduler.getPending(), 0u);
+}
+
+TEST(EmuZeta80SchedulerTest, PERIODIC_AND_CANCEL)
+{
+	CPU cpu(0x10000);
+	cpu.memory->load(0, LOOP_PROGRAM.data(), LOOP_PROGRAM.size());
+
+	Scheduler scheduler(&cpu, 2);
+	Device timer{&cpu}, once{&cpu};
+	int periodic = scheduler.schedule(100, &Device::callback, &timer, 100);
+	int cancelled = scheduler.schedule(150, &Device::callback, &once);
+
+	ASSERT_EQ(scheduler.schedule(200, &Device::callback, &once), -1);
+	ASSERT_TRUE(scheduler.cancel(cancelled));
+	ASSERT_FALSE(scheduler.cancel(cancelled));
+	ASSERT_EQ(scheduler.getNextCycle(), 100u);
+
+	scheduler.run(1000);
+	ASSERT_EQ(timer.scheduled.size(), 10u);
+	ASSERT_EQ(timer.scheduled.back(), 1000u);
+	ASSERT_TRUE(once.scheduled.empty());
+
+	ASSERT_TRUE(scheduler.cancel(periodic));
+	scheduler.run(1000);
+	ASSERT_EQ(timer.scheduled.size(), 10u);
+	ASSERT_EQ(scheduler.getNextCycle(), UINT64_MAX);
+}
+
+TEST(EmuZeta80SchedulerTest, TIMER_INTERRUPTS)
+{
+	// 0000: EI / IM 1 / JP 0003h
+	// 0038: INC A / EI / RET
+	CPU cpu(0x10000);
+	const uint8_t program[] = {0xFB, 0xED, 0x56, 0xC3, 0x03, 0x00};
+	const uint8_t handler[] = {0x3C, 0xFB, 0xC9};
+	cpu.memory->load(0, program, sizeof(program));
+	cpu.memory->load(0x38, handler, sizeof(handler));
+	cpu.sp.value = 0x8000;
+
+	struct Timer
+	{
+		static void tick(void* context, uint64_t)
+		{
+			static_cast<CPU*>(context)->interrupt();
+		}
+	};
+
+	Scheduler scheduler(&cpu);
+	scheduler.schedule(1000, &Timer::tick, &cpu, 1000);
+	scheduler.run(50000);
+
+	ASSERT_EQ(cpu.mainBank.af.bytes.H, 49);
+}
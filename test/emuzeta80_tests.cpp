@@ -1,5 +1,9 @@
 #include "emuzeta80_tests.h"
 #include <stdio.h>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
 #include "gtest/gtest.h"
 
 TEST_F(EmuZeta80Test, 00_NOP)
@@ -163,7 +167,7 @@ TEST_F(EmuZeta80Test, 10_DJNZ)
 
 	ASSERT_EQ(cpu->clockCycles, 13);
 	ASSERT_EQ(cpu->mainBank.bc.bytes.H, 3);
-	ASSERT_EQ(cpu->pc.value, 0x0C);
+	ASSERT_EQ(cpu->pc.value, 0x0D);
 }
 
 TEST_F(EmuZeta80Test, 11_LD_DE_NN)
@@ -245,7 +249,7 @@ TEST_F(EmuZeta80Test, 18_JR_D)
 	cpu->execute();
 
 	ASSERT_EQ(cpu->clockCycles, 12);
-	ASSERT_EQ(cpu->pc.value, 0x20);
+	ASSERT_EQ(cpu->pc.value, 0x21);
 }
 
 TEST_F(EmuZeta80Test, 19_ADD_HL_DE)
@@ -327,7 +331,7 @@ TEST_F(EmuZeta80Test, 20_JR_NZ_D)
 	cpu->execute();
 
 	ASSERT_EQ(cpu->clockCycles, 12);
-	ASSERT_EQ(cpu->pc.value, 0x20);
+	ASSERT_EQ(cpu->pc.value, 0x21);
 }
 
 TEST_F(EmuZeta80Test, 21_LD_HL_NN)
@@ -402,7 +406,7 @@ TEST_F(EmuZeta80Test, 28_JR_Z_D)
 	cpu->execute();
 
 	ASSERT_EQ(cpu->clockCycles, 12);
-	ASSERT_EQ(cpu->pc.value, 0x20);
+	ASSERT_EQ(cpu->pc.value, 0x21);
 }
 
 TEST_F(EmuZeta80Test, 29_ADD_HL_HL)
@@ -485,7 +489,7 @@ TEST_F(EmuZeta80Test, 30_JR_NC_D)
 	cpu->execute();
 
 	ASSERT_EQ(cpu->clockCycles, 12);
-	ASSERT_EQ(cpu->pc.value, 0x20);
+	ASSERT_EQ(cpu->pc.value, 0x21);
 }
 
 TEST_F(EmuZeta80Test, 31_LD_SP_NN)
@@ -571,7 +575,7 @@ TEST_F(EmuZeta80Test, 38_JR_C_D)
 	cpu->execute();
 
 	ASSERT_EQ(cpu->clockCycles, 12);
-	ASSERT_EQ(cpu->pc.value, 0x11);
+	ASSERT_EQ(cpu->pc.value, 0x12);
 }
 
 TEST_F(EmuZeta80Test, 39_ADD_HL_SP)
@@ -2491,8 +2495,8 @@ TEST_F(EmuZeta80Test, E9_JP_mHL)
 	cpu->memory->poke(0, 0xE9);
 	cpu->execute();
 
-	ASSERT_EQ(cpu->clockCycles, 10);
-	ASSERT_EQ(cpu->pc.value, 0x5B30);
+	ASSERT_EQ(cpu->clockCycles, 4);
+	ASSERT_EQ(cpu->pc.value, 0x2040);
 }
 
 TEST_F(EmuZeta80Test, EA_JP_PE_NN)
@@ -2719,6 +2723,453 @@ TEST_F(EmuZeta80Test, FF_RST_38)
 	ASSERT_EQ(cpu->memory->peek(0x7FFE), 0x01);
 }
 
+// Block instructions inside CPU::run (bulk copies) must match executing every iteration
+static void compareBlockRun(const std::vector<uint8_t>& program, uint16_t hl, uint16_t de, uint16_t bc, uint64_t cycles)
+{
+	emuzeta80::CPU bulk(0x10000), single(0x10000);
+	for(auto cpu : {&bulk, &single})
+	{
+		for(uint32_t address = 0; address < 0x10000; address++)
+			cpu->memory->poke(address, (uint8_t)(address * 7 + (address >> 8)));
+		for(size_t i = 0; i < program.size(); i++)
+			cpu->memory->poke(i, program[i]);
+		cpu->mainBank.hl.value = hl;
+		cpu->mainBank.de.value = de;
+		cpu->mainBank.bc.value = bc;
+		cpu->mainBank.af.value = 0x5A00;
+	}
+
+	uint64_t instructions = bulk.run(cycles);
+	uint64_t count = 0;
+	while(single.clockCycles < cycles)
+	{
+		single.execute();
+		count++;
+	}
+
+	ASSERT_EQ(instructions, count);
+	ASSERT_EQ(bulk.clockCycles, single.clockCycles);
+	ASSERT_EQ(bulk.pc.value, single.pc.value);
+	ASSERT_EQ(bulk.mainBank.af.value, single.mainBank.af.value);
+	ASSERT_EQ(bulk.mainBank.bc.value, single.mainBank.bc.value);
+	ASSERT_EQ(bulk.mainBank.de.value, single.mainBank.de.value);
+	ASSERT_EQ(bulk.mainBank.hl.value, single.mainBank.hl.value);
+	for(uint32_t address = 0; address < 0x10000; address++)
+		ASSERT_EQ(bulk.memory->peek(address), single.memory->peek(address)) << address;
+}
+
+TEST_F(EmuZeta80Test, ED_B0_LDIR_BULK)
+{
+	const std::vector<uint8_t> ldir = {0xED, 0xB0, 0x76};
+
+	compareBlockRun(ldir, 0x8000, 0x9000, 0x0800, 100000); // disjoint
+	compareBlockRun(ldir, 0x8000, 0x8001, 0x0800, 100000); // fill
+	compareBlockRun(ldir, 0x8000, 0x8003, 0x0800, 100000); // overlapping pattern
+	compareBlockRun(ldir, 0x8003, 0x8000, 0x0800, 100000); // overlapping, harmless direction
+	compareBlockRun(ldir, 0xFF00, 0x4000, 0x0200, 100000); // source wraps around
+	compareBlockRun(ldir, 0x8000, 0x9000, 0x0000, 10000);  // 64 KiB, stops at the budget
+	compareBlockRun(ldir, 0x8000, 0x9000, 0x0800, 1000);   // stops at the budget
+}
+
+TEST_F(EmuZeta80Test, ED_B8_LDDR_BULK)
+{
+	const std::vector<uint8_t> lddr = {0xED, 0xB8, 0x76};
+
+	compareBlockRun(lddr, 0x8800, 0x9800, 0x0800, 100000);
+	compareBlockRun(lddr, 0x8800, 0x87FF, 0x0800, 100000);
+	compareBlockRun(lddr, 0x8800, 0x8700, 0x0800, 100000);
+	compareBlockRun(lddr, 0x8700, 0x8800, 0x0800, 100000);
+	compareBlockRun(lddr, 0x0100, 0x9000, 0x0200, 100000);
+}
+
+TEST_F(EmuZeta80Test, ED_B1_CPIR_RUN)
+{
+	const std::vector<uint8_t> cpir = {0xED, 0xB1, 0x76};
+
+	compareBlockRun(cpir, 0x8000, 0x0000, 0x0800, 100000);
+	compareBlockRun(cpir, 0x8000, 0x0000, 0x0000, 3000);
+}
+
+TEST_F(EmuZeta80Test, ED_B0_LDIR_INTERRUPT)
+{
+	// EI / IM 1 / LDIR, interrupt requested during the copy
+	const uint8_t program[] = {0xFB, 0xED, 0x56, 0xED, 0xB0};
+	for(size_t i = 0; i < sizeof(program); i++)
+		cpu->memory->poke(i, program[i]);
+	cpu->mainBank.hl.value = 0x2000;
+	cpu->mainBank.de.value = 0x3000;
+	cpu->mainBank.bc.value = 0x0100;
+	cpu->sp.value = 0x8000;
+
+	cpu->run(4 + 8 + 21 * 10);
+	ASSERT_EQ(cpu->mainBank.bc.value, 0x0100 - 10);
+	ASSERT_EQ(cpu->pc.value, 0x0003);
+
+	cpu->interrupt();
+	cpu->run(1);
+
+	ASSERT_EQ(cpu->pc.value, 0x0038);
+	ASSERT_EQ(cpu->iff1, false);
+	ASSERT_EQ(cpu->memory->peek(0x7FFF), 0x00);
+	ASSERT_EQ(cpu->memory->peek(0x7FFE), 0x03);
+	ASSERT_EQ(cpu->mainBank.bc.value, 0x0100 - 10);
+}
+
+TEST_F(EmuZeta80Test, ED_5E_IM_2_INTERRUPT)
+{
+	// LD A, 40h / LD I, A / IM 2 / EI / NOP
+	const uint8_t program[] = {0x3E, 0x40, 0xED, 0x47, 0xED, 0x5E, 0xFB, 0x00};
+	for(size_t i = 0; i < sizeof(program); i++)
+		cpu->memory->poke(i, program[i]);
+	cpu->memory->poke(0x4010, 0x34);
+	cpu->memory->poke(0x4011, 0x12);
+	cpu->sp.value = 0x8000;
+	cpu->interrupt(0x10);
+
+	for(int step = 0; step < 4; step++)
+		cpu->execute();
+
+	// Not accepted right after EI
+	cpu->execute();
+	ASSERT_EQ(cpu->pc.value, 0x0008);
+
+	uint64_t cycles = cpu->clockCycles;
+	cpu->execute();
+	ASSERT_EQ(cpu->pc.value, 0x1234);
+	ASSERT_EQ(cpu->clockCycles - cycles, 19);
+	ASSERT_EQ(cpu->memory->peek(0x7FFE), 0x08);
+}
+
+TEST_F(EmuZeta80Test, ED_B3_OTIR_PORTS)
+{
+	struct Ports
+	{
+		std::vector<std::pair<uint16_t, uint8_t>> writes;
+	} ports;
+
+	cpu->ioContext = &ports;
+	cpu->output = [](void* context, uint16_t port, uint8_t value) {
+		static_cast<Ports*>(context)->writes.push_back(std::make_pair(port, value));
+	};
+	cpu->input = [](void*, uint16_t port) -> uint8_t { return port & 0xFF; };
+
+	// OTIR / IN A, (C)
+	const uint8_t program[] = {0xED, 0xB3, 0xED, 0x78};
+	for(size_t i = 0; i < sizeof(program); i++)
+		cpu->memory->poke(i, program[i]);
+	cpu->memory->poke(0x2000, 0xAA);
+	cpu->memory->poke(0x2001, 0xBB);
+	cpu->mainBank.hl.value = 0x2000;
+	cpu->mainBank.bc.value = 0x0242;
+
+	cpu->run(21 + 16 + 12);
+
+	ASSERT_EQ(ports.writes.size(), 2u);
+	ASSERT_EQ(ports.writes[0].first, 0x0142);
+	ASSERT_EQ(ports.writes[0].second, 0xAA);
+	ASSERT_EQ(ports.writes[1].first, 0x0042);
+	ASSERT_EQ(ports.writes[1].second, 0xBB);
+	ASSERT_EQ(cpu->mainBank.af.bytes.H, 0x42);
+	ASSERT_EQ(cpu->clockCycles, 21 + 16 + 12);
+}
+
+TEST_F(EmuZeta80Test, ED_B2_INIR_CYCLES)
+{
+	struct Device
+	{
+		emuzeta80::CPU* cpu;
+		std::vector<uint64_t> reads;
+	} device = {cpu, {}};
+
+	// Every input sees the clock cycles of its own iteration
+	cpu->ioContext = &device;
+	cpu->input = [](void* context, uint16_t) -> uint8_t {
+		Device* device = static_cast<Device*>(context);
+		device->reads.push_back(device->cpu->clockCycles);
+		return 0x55;
+	};
+
+	cpu->memory->poke(0, 0xED);
+	cpu->memory->poke(1, 0xB2);
+	cpu->mainBank.hl.value = 0x2000;
+	cpu->mainBank.bc.value = 0x0342;
+
+	ASSERT_EQ(cpu->run(21 + 21 + 16), 3u);
+	ASSERT_EQ(device.reads, std::vector<uint64_t>({0, 21, 42}));
+	ASSERT_EQ(cpu->memory->peek(0x2002), 0x55);
+
+	// INIR stops when it overwrites its own opcode (ED 00 runs as a NOP)
+	cpu->input = [](void*, uint16_t) -> uint8_t { return 0x00; };
+	cpu->pc.value = 0;
+	cpu->mainBank.hl.value = 0x0001;
+	cpu->mainBank.bc.value = 0x0342;
+	cpu->run(21 + 8);
+	ASSERT_EQ(cpu->pc.value, 0x0002);
+	ASSERT_EQ(cpu->mainBank.hl.value, 0x0002);
+	ASSERT_EQ(cpu->mainBank.bc.bytes.H, 0x02);
+}
+
+// Idle loops skipped by CPU::run must give the same state as executing them
+static void compareIdleRun(const std::vector<uint8_t>& program, uint64_t cycles, uint64_t slices)
+{
+	emuzeta80::CPU skip(0x10000), single(0x10000);
+	skip.skipIdleLoops = true;
+
+	uint64_t skipInstructions = 0, singleInstructions = 0;
+	for(auto cpu : {&skip, &single})
+	{
+		for(size_t i = 0; i < program.size(); i++)
+			cpu->memory->poke(i, program[i]);
+		cpu->sp.value = 0x8000;
+	}
+
+	for(uint64_t slice = 0; slice < slices; slice++)
+	{
+		// Memory changed between slices (as a device would do)
+		skip.memory->poke(0x9000, (uint8_t)slice);
+		single.memory->poke(0x9000, (uint8_t)slice);
+
+		skipInstructions += skip.run(cycles);
+		singleInstructions += single.run(cycles);
+	}
+
+	ASSERT_EQ(skipInstructions, singleInstructions);
+	ASSERT_EQ(skip.clockCycles, single.clockCycles);
+	ASSERT_EQ(skip.pc.value, single.pc.value);
+	ASSERT_EQ(skip.getr(), single.getr());
+	ASSERT_EQ(skip.mainBank.af.value, single.mainBank.af.value);
+	ASSERT_EQ(skip.mainBank.bc.value, single.mainBank.bc.value);
+	ASSERT_EQ(skip.mainBank.de.value, single.mainBank.de.value);
+	ASSERT_EQ(skip.mainBank.hl.value, single.mainBank.hl.value);
+}
+
+TEST_F(EmuZeta80Test, IDLE_LOOP_BUSY_WAIT)
+{
+	// 0000: LD A, (9000h) / AND 01h / JR Z, 0000h / INC E / JP 0000h
+	compareIdleRun({0x3A, 0x00, 0x90, 0xE6, 0x01, 0x28, 0xF9, 0x1C, 0xC3, 0x00, 0x00}, 10000, 20);
+	compareIdleRun({0x3A, 0x00, 0x90, 0xE6, 0x01, 0x28, 0xF9, 0x1C, 0xC3, 0x00, 0x00}, 37, 500);
+
+	// The branch of the probe iteration ends past the budget
+	for(uint64_t cycles = 53; cycles <= 63; cycles++)
+		compareIdleRun({0x3A, 0x00, 0x90, 0xE6, 0x01, 0x28, 0xF9, 0x1C, 0xC3, 0x00, 0x00}, cycles, 1);
+
+	// 0000: LD A, (9000h) / BIT 0, A / JR Z, 0000h / INC E / JP 0000h
+	compareIdleRun({0x3A, 0x00, 0x90, 0xCB, 0x47, 0x28, 0xF9, 0x1C, 0xC3, 0x00, 0x00}, 10000, 20);
+}
+
+TEST_F(EmuZeta80Test, IDLE_LOOP_WATCHED)
+{
+	// 0000: LD A, (9000h) / AND 01h / JR Z, 0000h
+	const std::vector<uint8_t> program = {0x3A, 0x00, 0x90, 0xE6, 0x01, 0x28, 0xF9};
+	emuzeta80::CPU cpu(0x10000);
+	cpu.memory->load(0, program.data(), program.size());
+	cpu.skipIdleLoops = true;
+
+	// The reads of a watched page are reported, so every iteration runs (32 cycles)
+	uint64_t reads = 0;
+	cpu.memory->watch(0x9000, 1, true, false);
+	cpu.memory->setWatchCallback([](void* context, uint16_t, uint8_t, bool) { (*(uint64_t*)context)++; }, &reads);
+	ASSERT_EQ(cpu.run(32 * 100), 300u);
+	ASSERT_EQ(reads, 100u);
+}
+
+TEST_F(EmuZeta80Test, IDLE_LOOP_DJNZ)
+{
+	// 0000: LD B, C8h / NOP / DJNZ 0002h / INC D / JP 0000h
+	compareIdleRun({0x06, 0xC8, 0x00, 0x10, 0xFD, 0x14, 0xC3, 0x00, 0x00}, 10000, 20);
+	compareIdleRun({0x06, 0xC8, 0x00, 0x10, 0xFD, 0x14, 0xC3, 0x00, 0x00}, 53, 500);
+
+	// DJNZ with a body that reads B is not skipped in closed form
+	// 0000: LD B, 00h / LD A, B / XOR C / LD C, A / DJNZ 0002h / JP 0000h
+	compareIdleRun({0x06, 0x00, 0x78, 0xA9, 0x4F, 0x10, 0xFB, 0xC3, 0x00, 0x00}, 10000, 20);
+}
+
+TEST(EmuZeta80RefreshTest, M1_CYCLES)
+{
+	// 0000: LD A, 85h / LD R, A / NOP / LD IX, 0000h / RLC B / BIT 0, (IY+0) / LD BC, 0003h / LD HL, 4000h
+	// 0015: LD DE, 5000h / LDIR / LD A, R / JR $
+	const std::vector<uint8_t> program = {0x3E, 0x85, 0xED, 0x4F, 0x00, 0xDD, 0x21, 0x00, 0x00, 0xCB,
+	                                      0x00, 0xFD, 0xCB, 0x00, 0x46, 0x01, 0x03, 0x00, 0x21, 0x00,
+	                                      0x40, 0x11, 0x00, 0x50, 0xED, 0xB0, 0xED, 0x5F, 0x18, 0xFE};
+	emuzeta80::CPU step(0x10000), run(0x10000);
+	step.memory->load(0, program.data(), program.size());
+	run.memory->load(0, program.data(), program.size());
+
+	// 1 + 2 + 2 + 2 + 1 + 1 + 1 + 3 * 2 + 2 M1 cycles after LD R, A (bit 7 is kept)
+	while(step.pc.value != 0x001C)
+		step.execute();
+	run.run(1000);
+	ASSERT_EQ(step.mainBank.af.bytes.H, 0x97);
+	ASSERT_EQ(run.mainBank.af.bytes.H, 0x97);
+
+	// Only the low 7 bits count
+	step.setr(0xFF);
+	step.execute();
+	ASSERT_EQ(step.getr(), 0x80);
+
+	emuzeta80::Snapshot snapshot;
+	step.save(snapshot);
+	ASSERT_EQ(snapshot.r, 0x80);
+	snapshot.r = 0x12;
+	run.restore(snapshot);
+	run.execute();
+	ASSERT_EQ(run.getr(), 0x13);
+}
+
+TEST(EmuZeta80FixedTest, FIXED_RAM_MIRROR)
+{
+	emuzeta80::FixedRAM<0x4000> ram;
+	ram.poke(0x4001, 0x12);
+	ASSERT_EQ(ram.peek(0x0001), 0x12);
+	ASSERT_EQ(ram.peek(0xC001), 0x12);
+
+	const uint8_t data[] = {0x34, 0x56};
+	ram.load(0x3FFF, data, 2);
+	ASSERT_EQ(ram.peek(0x3FFF), 0x34);
+	ASSERT_EQ(ram.peek(0x0000), 0x56);
+}
+
+TEST(EmuZeta80FixedTest, SAME_AS_CPU)
+{
+	// 0000: LD HL, 8000h / LD B, 00h / LD (HL), B / INC HL / DJNZ 0005h / LD DE, 9000h / LD HL, 8000h / LD BC, 0100h / LDIR / HALT
+	const std::vector<uint8_t> program = {0x21, 0x00, 0x80, 0x06, 0x00, 0x70, 0x23, 0x10, 0xFC, 0x11, 0x00,
+	                                      0x90, 0x21, 0x00, 0x80, 0x01, 0x00, 0x01, 0xED, 0xB0, 0x76};
+	emuzeta80::CPU cpu(0x10000);
+	emuzeta80::FixedCPU<> fixed;
+	cpu.memory->load(0, program.data(), program.size());
+	fixed.memory->load(0, program.data(), program.size());
+
+	ASSERT_EQ(cpu.run(10000), fixed.run(10000));
+	ASSERT_EQ(cpu.pc.value, fixed.pc.value);
+	ASSERT_EQ(cpu.clockCycles, fixed.clockCycles);
+	for(uint32_t address = 0; address < 0x10000; address++)
+		ASSERT_EQ(cpu.memory->peek(address), fixed.memory->peek(address));
+}
+
+TEST(EmuZeta80ArenaTest, PLACEMENT_NEW)
+{
+	typedef emuzeta80::FixedCPU<> SmallCPU;
+	static_assert(!std::is_copy_constructible<SmallCPU>::value, "a CPU owns its memory");
+
+	// 0000: INC A / JR 0000h
+	const uint8_t program[] = {0x3C, 0x18, 0xFD};
+	const size_t count = 8;
+	std::vector<std::aligned_storage<sizeof(SmallCPU), alignof(SmallCPU)>::type> arena(count);
+	SmallCPU* cpus = reinterpret_cast<SmallCPU*>(arena.data());
+	for(size_t index = 0; index < count; index++)
+	{
+		SmallCPU* cpu = new(&cpus[index]) SmallCPU();
+		ASSERT_GE((uintptr_t)cpu->memory, (uintptr_t)cpu);
+		ASSERT_LT((uintptr_t)cpu->memory, (uintptr_t)(cpu + 1));
+		cpu->memory->load(0, program, sizeof(program));
+		cpu->run(1000 + index * 100);
+	}
+
+	for(size_t index = 1; index < count; index++)
+		ASSERT_GT(cpus[index].mainBank.af.bytes.H, cpus[index - 1].mainBank.af.bytes.H);
+	for(size_t index = 0; index < count; index++)
+		cpus[index].~SmallCPU();
+}
+
+TEST(EmuZeta80ArenaTest, ALIGNED_MEMBER)
+{
+	// A host object with a CPU member allocated by new (aligned by -faligned-new)
+	struct Host
+	{
+		int id;
+		emuzeta80::CPU cpu;
+	};
+
+	std::vector<std::unique_ptr<Host>> hosts;
+	for(int index = 0; index < 16; index++)
+	{
+		hosts.emplace_back(new Host());
+		ASSERT_EQ((uintptr_t)&hosts.back()->cpu % 64, 0u);
+	}
+
+	std::unique_ptr<emuzeta80::CPU> cpu(new emuzeta80::CPU(0x10000));
+	ASSERT_EQ((uintptr_t)cpu.get() % 64, 0u);
+}
+
+namespace
+{
+
+struct RomWrite
+{
+	uint16_t address;
+	uint8_t value;
+	int count;
+};
+
+void onRomWrite(void* context, uint16_t address, uint8_t value)
+{
+	RomWrite* write = static_cast<RomWrite*>(context);
+	write->address = address;
+	write->value = value;
+	write->count++;
+}
+
+} // namespace
+
+TEST(EmuZeta80RomTest, ROM_WRITES)
+{
+	emuzeta80::RAM ram(0x10000);
+	const uint8_t image[] = {0x12, 0x34};
+	ram.protect(0x0000, 0x4000);
+	ram.load(0x3FFF, image, 2);
+	ASSERT_EQ(ram.peek(0x3FFF), 0x12);
+	ASSERT_TRUE(ram.isProtected(0x3FFF));
+	ASSERT_FALSE(ram.isProtected(0x4000));
+
+	RomWrite write = {0, 0, 0};
+	ram.setRomWriteCallback(onRomWrite, &write);
+	ram.poke(0x3FFF, 0xAA);
+	ram.poke(0x4000, 0xBB);
+	ASSERT_EQ(ram.peek(0x3FFF), 0x12);
+	ASSERT_EQ(ram.peek(0x4000), 0xBB);
+	ASSERT_EQ(ram.getRomWrites(), 1u);
+	ASSERT_EQ(write.address, 0x3FFF);
+	ASSERT_EQ(write.value, 0xAA);
+	ASSERT_EQ(write.count, 1);
+
+	// Block writes are dropped only inside the ROM
+	ram.fill(0x3FFE, 0xCC, 4);
+	ASSERT_EQ(ram.peek(0x3FFF), 0x12);
+	ASSERT_EQ(ram.peek(0x4001), 0xCC);
+	ASSERT_EQ(ram.getRomWrites(), 3u);
+
+	ram.protect(0x0000, 0x4000, false);
+	ram.poke(0x3FFF, 0xAA);
+	ASSERT_EQ(ram.peek(0x3FFF), 0xAA);
+	ASSERT_EQ(ram.getRomWrites(), 3u);
+}
+
+TEST(EmuZeta80RomTest, BLOCK_INSTRUCTIONS)
+{
+	// 0000: LD HL, 3F00h / LD DE, 3F01h / LD BC, 0200h / LD (HL), 77h / LDIR / JR 000Dh
+	const std::vector<uint8_t> program = {0x21, 0x00, 0x3F, 0x11, 0x01, 0x3F, 0x01, 0x00,
+	                                      0x02, 0x36, 0x77, 0xED, 0xB0, 0x18, 0xFE};
+	emuzeta80::CPU bulk(0x10000), single(0x10000);
+	for(emuzeta80::CPU* cpu : {&bulk, &single})
+	{
+		cpu->memory->load(0, program.data(), program.size());
+		cpu->memory->protect(0x4000, 0x100);
+	}
+
+	bulk.run(20000);
+	while(single.pc.value != 0x000D)
+		single.execute();
+
+	ASSERT_EQ(bulk.pc.value, 0x000D);
+	ASSERT_EQ(bulk.memory->getRomWrites(), 0x100u);
+	ASSERT_EQ(single.memory->getRomWrites(), 0x100u);
+	for(uint32_t address = 0x3F00; address < 0x4200; address++)
+		ASSERT_EQ(bulk.memory->peek(address), single.memory->peek(address));
+	ASSERT_EQ(bulk.memory->peek(0x3FFF), 0x77);
+	ASSERT_EQ(bulk.memory->peek(0x4000), 0x00);
+	ASSERT_EQ(bulk.memory->peek(0x4100), 0x00);
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleMock(&argc, argv);
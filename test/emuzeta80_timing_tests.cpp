@@ -0,0 +1,224 @@
+#include "CPU.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace emuzeta80;
+
+namespace
+{
+
+struct Event
+{
+	BusCycle cycle;
+	uint16_t address;
+	uint16_t tstate;
+};
+
+// Records the machine cycles and inserts waitStates in 4000h-7FFFh
+struct Bus
+{
+	std::vector<Event> events;
+	uint8_t waitStates = 0;
+
+	static uint8_t contention(void* context, BusCycle cycle, uint16_t address, uint16_t tstate)
+	{
+		Bus* bus = static_cast<Bus*>(context);
+		bus->events.push_back(Event{cycle, address, tstate});
+		return (address & 0xC000) == 0x4000 ? bus->waitStates : 0;
+	}
+};
+
+class EmuZeta80TimingTest : public ::testing::Test
+{
+protected:
+	EmuZeta80TimingTest() : cpu(0x10000)
+	{
+		cpu.contention = &Bus::contention;
+		cpu.busContext = &bus;
+	}
+
+	void load(uint16_t address, const std::vector<uint8_t>& program)
+	{
+		cpu.memory->load(address, program.data(), program.size());
+		cpu.pc.value = address;
+	}
+
+	void expect(const std::vector<Event>& expected)
+	{
+		ASSERT_EQ(bus.events.size(), expected.size());
+		for(size_t i = 0; i < expected.size(); i++)
+		{
+			EXPECT_EQ(bus.events[i].cycle, expected[i].cycle) << "event " << i;
+			EXPECT_EQ(bus.events[i].address, expected[i].address) << "event " << i;
+			EXPECT_EQ(bus.events[i].tstate, expected[i].tstate) << "event " << i;
+		}
+	}
+
+	CPU cpu;
+	Bus bus;
+};
+
+} // namespace
+
+TEST_F(EmuZeta80TimingTest, MEMORY_READ)
+{
+	// LD A, (HL)
+	load(0x0000, {0x7E});
+	cpu.mainBank.hl.value = 0x8000;
+	cpu.execute();
+
+	expect({{BUS_FETCH, 0x0000, 0}, {BUS_READ, 0x8000, 4}});
+	ASSERT_EQ(cpu.clockCycles, 7u);
+}
+
+TEST_F(EmuZeta80TimingTest, CONTENDED_WRITE)
+{
+	// LD (HL), A
+	load(0x4000, {0x77});
+	cpu.mainBank.hl.value = 0x4100;
+	bus.waitStates = 2;
+	cpu.execute();
+
+	expect({{BUS_FETCH, 0x4000, 0}, {BUS_WRITE, 0x4100, 6}});
+	ASSERT_EQ(cpu.clockCycles, 7u + 4u);
+}
+
+TEST_F(EmuZeta80TimingTest, IO_WRITE)
+{
+	// OUT (34h), A
+	load(0x0000, {0xD3, 0x34});
+	cpu.mainBank.af.bytes.H = 0x12;
+	cpu.execute();
+
+	expect({{BUS_FETCH, 0x0000, 0}, {BUS_READ, 0x0001, 4}, {BUS_OUTPUT, 0x1234, 7}});
+	ASSERT_EQ(cpu.clockCycles, 11u);
+}
+
+TEST_F(EmuZeta80TimingTest, INDEXED_READ)
+{
+	// LD A, (IX+5)
+	load(0x0000, {0xDD, 0x7E, 0x05});
+	cpu.iX.value = 0x9000;
+	cpu.execute();
+
+	// 5 T-states of address calculation after the displacement
+	expect({{BUS_FETCH, 0x0000, 0}, {BUS_FETCH, 0x0001, 4}, {BUS_READ, 0x0002, 8}, {BUS_READ, 0x9005, 16}});
+	ASSERT_EQ(cpu.clockCycles, 19u);
+}
+
+TEST_F(EmuZeta80TimingTest, READ_MODIFY_WRITE)
+{
+	// INC (HL)
+	load(0x0000, {0x34});
+	cpu.mainBank.hl.value = 0x8000;
+	cpu.execute();
+
+	expect({{BUS_FETCH, 0x0000, 0}, {BUS_READ, 0x8000, 4}, {BUS_WRITE, 0x8000, 8}});
+	ASSERT_EQ(cpu.clockCycles, 11u);
+}
+
+TEST_F(EmuZeta80TimingTest, PUSH)
+{
+	// PUSH BC (5 T-states M1)
+	load(0x0000, {0xC5});
+	cpu.sp.value = 0x8000;
+	cpu.execute();
+
+	expect({{BUS_FETCH, 0x0000, 0}, {BUS_WRITE, 0x7FFF, 5}, {BUS_WRITE, 0x7FFE, 8}});
+	ASSERT_EQ(cpu.clockCycles, 11u);
+}
+
+TEST_F(EmuZeta80TimingTest, CALL_TAKEN)
+{
+	// CALL 1234h
+	load(0x0000, {0xCD, 0x34, 0x12});
+	cpu.sp.value = 0x8000;
+	cpu.execute();
+
+	expect({{BUS_FETCH, 0x0000, 0}, {BUS_READ, 0x0001, 4}, {BUS_READ, 0x0002, 7},
+	        {BUS_WRITE, 0x7FFF, 11}, {BUS_WRITE, 0x7FFE, 14}});
+	ASSERT_EQ(cpu.pc.value, 0x1234);
+	ASSERT_EQ(cpu.clockCycles, 17u);
+}
+
+TEST_F(EmuZeta80TimingTest, CALL_NOT_TAKEN)
+{
+	// CALL Z, 1234h
+	load(0x0000, {0xCC, 0x34, 0x12});
+	cpu.sp.value = 0x8000;
+	cpu.execute();
+
+	expect({{BUS_FETCH, 0x0000, 0}, {BUS_READ, 0x0001, 4}, {BUS_READ, 0x0002, 7}});
+	ASSERT_EQ(cpu.pc.value, 0x0003);
+	ASSERT_EQ(cpu.clockCycles, 10u);
+}
+
+TEST_F(EmuZeta80TimingTest, BLOCK_ITERATIONS)
+{
+	// LDIR
+	load(0x0000, {0xED, 0xB0});
+	cpu.mainBank.hl.value = 0x8000;
+	cpu.mainBank.de.value = 0x9000;
+	cpu.mainBank.bc.value = 0x0003;
+
+	ASSERT_EQ(cpu.run(21 + 21 + 16), 3u);
+
+	std::vector<Event> expected;
+	for(uint16_t i = 0; i < 3; i++)
+	{
+		expected.push_back({BUS_FETCH, 0x0000, 0});
+		expected.push_back({BUS_FETCH, 0x0001, 4});
+		expected.push_back({BUS_READ, (uint16_t)(0x8000 + i), 8});
+		expected.push_back({BUS_WRITE, (uint16_t)(0x9000 + i), 11});
+	}
+	expect(expected);
+	ASSERT_EQ(cpu.clockCycles, 58u);
+}
+
+TEST(EmuZeta80TimingSweepTest, TSTATES_MATCH_CYCLES)
+{
+	// The machine cycles and internal cycles of every instruction add up to its clock cycles
+	// Exposes the T-states counted for the current instruction
+	struct TimedCPU : CPU
+	{
+		TimedCPU() : CPU(0x10000) { }
+		uint16_t tstates() { return tstate; }
+	};
+
+	const std::vector<std::vector<uint8_t>> prefixes = {
+		{}, {0xCB}, {0xED}, {0xDD}, {0xFD}, {0xDD, 0xCB, 0x05}, {0xFD, 0xCB, 0x05}};
+
+	for(auto& prefix : prefixes)
+	{
+		for(int opcode = 0; opcode < 0x100; opcode++)
+		{
+			// Prefixes are covered by their own rows
+			bool prefixed = opcode == 0xCB || opcode == 0xDD || opcode == 0xED || opcode == 0xFD;
+			if(prefixed && (prefix.empty() || (prefix.size() == 1 && prefix[0] != 0xCB && prefix[0] != 0xED)))
+				continue;
+
+			// Repeated and final iterations of the block instructions, both branches of the conditions
+			for(uint16_t bc : {0x0101, 0x0201})
+			{
+				for(uint8_t flags : {0x00, 0xFF})
+				{
+					TimedCPU cpu;
+					std::vector<uint8_t> program = prefix;
+					program.insert(program.end(), {(uint8_t)opcode, 0x05, 0x40});
+					cpu.memory->load(0x0000, program.data(), program.size());
+					cpu.mainBank.af.bytes.L = flags;
+					cpu.mainBank.bc.value = bc;
+					cpu.mainBank.hl.value = 0x9000;
+					cpu.iX.value = 0xA000;
+					cpu.iY.value = 0xB000;
+					cpu.sp.value = 0x8000;
+
+					cpu.execute();
+					EXPECT_EQ(cpu.tstates(), cpu.clockCycles)
+						<< std::hex << "prefix " << (prefix.empty() ? 0 : (int)prefix[0]) << " opcode " << opcode
+						<< " bc " << bc << " flags " << (int)flags;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,170 @@
+#include "Traps.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+using namespace emuzeta80;
+
+namespace
+{
+
+const uint16_t MULTIPLY = 0x0100;
+
+// 0000: LD SP, F000h / LD H, 07h / LD E, 0Dh / CALL 0100h / LD (9000h), HL / JP 000Dh
+const std::vector<uint8_t> MAIN_PROGRAM = {0x31, 0x00, 0xF0, 0x26, 0x07, 0x1E, 0x0D, 0xCD,
+                                           0x00, 0x01, 0x22, 0x00, 0x90, 0xC3, 0x0D, 0x00};
+
+// 0100: HL = H * E (LD B, H / LD HL, 0000h / LD D, 0 / ADD HL, DE / DEC B / JP NZ, 0106h / RET)
+const std::vector<uint8_t> MULTIPLY_ROUTINE = {0x44, 0x21, 0x00, 0x00, 0x16, 0x00, 0x19, 0x05,
+                                               0xC2, 0x06, 0x01, 0xC9};
+
+void load(CPU& cpu)
+{
+	cpu.memory->load(0, MAIN_PROGRAM.data(), MAIN_PROGRAM.size());
+	cpu.memory->load(MULTIPLY, MULTIPLY_ROUTINE.data(), MULTIPLY_ROUTINE.size());
+}
+
+uint64_t multiply(void* context, RegistersBank* bank, RAM* memory)
+{
+	bank->hl.value = bank->hl.bytes.H * bank->de.bytes.L;
+	bank->de.bytes.H = 0;
+	bank->bc.bytes.H = 0;
+	return 0;
+}
+
+uint64_t wrongMultiply(void* context, RegistersBank* bank, RAM* memory)
+{
+	multiply(context, bank, memory);
+	bank->hl.value += 1;
+	return 0;
+}
+
+uint16_t product(CPU& cpu)
+{
+	return cpu.memory->peek(0x9000) | (cpu.memory->peek(0x9001) << 8);
+}
+
+} // namespace
+
+TEST(EmuZeta80TrapsTest, NATIVE_ROUTINE)
+{
+	CPU guest(0x10000), native(0x10000);
+	load(guest);
+	load(native);
+
+	Traps traps(&native);
+	traps.add(MULTIPLY, &multiply, nullptr, 100);
+
+	guest.run(2000);
+	traps.run(2000);
+	ASSERT_EQ(product(guest), 91);
+	ASSERT_EQ(product(native), 91);
+	ASSERT_EQ(native.pc.value, guest.pc.value);
+	ASSERT_EQ(native.sp.value, guest.sp.value);
+	ASSERT_EQ(traps.getCalls(MULTIPLY), 1u);
+	ASSERT_EQ(traps.getMismatches(MULTIPLY), 0u);
+
+	// LD SP, LD H, LD E, CALL (41 cycles) and the declared cost
+	Traps timed(&native);
+	timed.add(MULTIPLY, &multiply, nullptr, 100);
+	native.pc.value = 0;
+	native.clockCycles = 0;
+	ASSERT_EQ(timed.run(41), 4u);
+	ASSERT_EQ(timed.run(1), 1u);
+	ASSERT_EQ(native.clockCycles, 141u);
+	ASSERT_EQ(native.pc.value, 0x000A);
+}
+
+TEST(EmuZeta80TrapsTest, VERIFICATION)
+{
+	CPU cpu(0x10000);
+	load(cpu);
+
+	Traps traps(&cpu);
+	traps.verify = true;
+	traps.add(MULTIPLY, &multiply, nullptr, 100);
+	traps.run(2000);
+	ASSERT_EQ(product(cpu), 91);
+	ASSERT_EQ(traps.getCalls(MULTIPLY), 1u);
+	ASSERT_EQ(traps.getMismatches(MULTIPLY), 0u);
+
+	// The result of the guest routine is kept
+	CPU other(0x10000);
+	load(other);
+	Traps wrong(&other);
+	wrong.verify = true;
+	wrong.add(MULTIPLY, &wrongMultiply, nullptr, 100);
+	wrong.run(2000);
+	ASSERT_EQ(product(other), 91);
+	ASSERT_EQ(wrong.getMismatches(MULTIPLY), 1u);
+	ASSERT_EQ(other.clockCycles, cpu.clockCycles);
+}
+
+TEST(EmuZeta80TrapsTest, VERIFY_CYCLES)
+{
+	CPU cpu(0x10000);
+	load(cpu);
+
+	// The declared cost is compared with the guest routine
+	Traps traps(&cpu);
+	traps.verify = true;
+	traps.add(MULTIPLY, &multiply, nullptr, 100);
+	traps.run(2000);
+	int64_t difference = traps.getCycleDifference(MULTIPLY);
+	ASSERT_GT(difference, 0);
+	ASSERT_EQ(traps.getMismatches(MULTIPLY), 0u);
+
+	// Wrong exact cycles are a mismatch
+	for(int64_t error : {int64_t(0), int64_t(1)})
+	{
+		CPU exact(0x10000);
+		load(exact);
+		Traps checked(&exact);
+		checked.verify = true;
+		checked.add(MULTIPLY, &multiply, nullptr, 100 + difference + error, true);
+		checked.run(2000);
+		ASSERT_EQ(checked.getCycleDifference(MULTIPLY), -error);
+		ASSERT_EQ(checked.getMismatches(MULTIPLY), (uint64_t)error);
+	}
+}
+
+TEST(EmuZeta80TrapsTest, REMOVE)
+{
+	CPU cpu(0x10000);
+	load(cpu);
+
+	Traps traps(&cpu);
+	traps.add(MULTIPLY, &wrongMultiply, nullptr, 100);
+	ASSERT_TRUE(traps.remove(MULTIPLY));
+	ASSERT_FALSE(traps.remove(MULTIPLY));
+
+	traps.run(2000);
+	ASSERT_EQ(product(cpu), 91);
+	ASSERT_EQ(traps.getCalls(MULTIPLY), 0u);
+}
+
+TEST(EmuZeta80TrapsTest, REMOVE_REUSES_ENTRIES)
+{
+	// Exposes the number of trap entries
+	struct CountingTraps : Traps
+	{
+		CountingTraps(CPU* cpu) : Traps(cpu) { }
+		size_t entries() { return traps.size(); }
+	};
+
+	CPU cpu(0x10000);
+	load(cpu);
+
+	CountingTraps traps(&cpu);
+	for(uint16_t address = 0x8000; address < 0x8100; address++)
+	{
+		traps.add(address, &wrongMultiply, nullptr, 100);
+		ASSERT_TRUE(traps.remove(address));
+	}
+	ASSERT_EQ(traps.entries(), 1u);
+
+	traps.add(MULTIPLY, &multiply, nullptr, 100);
+	ASSERT_EQ(traps.entries(), 1u);
+	traps.run(2000);
+	ASSERT_EQ(product(cpu), 91);
+	ASSERT_EQ(traps.getCalls(MULTIPLY), 1u);
+}
@@ -0,0 +1,202 @@
+/*
+ * emuzeta80 (emulator for z80)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/**
+ * @file emuzeta80_zex.cpp
+ * @ingroup emuzeta80
+ * @author Lumpi (iflumpi@gmail.com)
+ * @version 0.1
+ *
+ * @brief Runner for the ZEXDOC/ZEXALL instruction exercisers
+ *
+ * The .COM file is loaded at 0100h as in CP/M. Calls to the BDOS entry point
+ * (0005h) are trapped and served natively for the functions used by the
+ * exercisers (2: console output, 9: print string). A jump to 0000h (warm boot)
+ * terminates the program.
+ *
+ * Usage: emuzeta80_zex <file.com> [max instructions]
+ *
+ * The exit code is 0 only if every test group reported OK.
+ *
+ */
+
+//-------------------------------------------------------------------------
+// Includes
+//-------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "CPU.h"
+
+using namespace emuzeta80;
+
+//-------------------------------------------------------------------------
+// CP/M environment
+//-------------------------------------------------------------------------
+
+namespace
+{
+
+const uint16_t TPA_START = 0x0100;  //< Load address of .COM files
+const uint16_t BDOS_ENTRY = 0x0005; //< CALL 5 entry point
+const uint16_t BDOS_TOP = 0xFE00;   //< Top of the TPA stored at 0006h
+
+/**
+ * @brief Collects console output and classifies each test group line
+ */
+struct Console
+{
+    std::string line;
+    int passed = 0;
+    int failed = 0;
+
+    void put(char c)
+    {
+        std::putchar(c);
+        if(c != '\n')
+        {
+            if(c != '\r')
+                line += c;
+            return;
+        }
+
+        if(line.find("ERROR") != std::string::npos)
+            failed++;
+        else if(line.find("OK") != std::string::npos && line.find("..") != std::string::npos)
+            passed++;
+
+        line.clear();
+    }
+};
+
+/**
+ * @brief Load a .COM file into memory at 0100h
+ *
+ * @return true if the file could be read
+ */
+bool loadCOM(CPU& cpu, const char* path)
+{
+    FILE* file = std::fopen(path, "rb");
+    if(file == nullptr)
+        return false;
+
+    uint32_t address = TPA_START;
+    int c;
+    while((c = std::fgetc(file)) != EOF && address < BDOS_TOP)
+        cpu.memory->poke(address++, (uint8_t)c);
+
+    std::fclose(file);
+    return address > TPA_START;
+}
+
+/**
+ * @brief Serve a BDOS call and return to the caller
+ */
+void bdos(CPU& cpu, Console& console)
+{
+    switch(cpu.mainBank.bc.bytes.L)
+    {
+    case 2:
+    {
+        // C_WRITE: output character in E
+        console.put((char)cpu.mainBank.de.bytes.L);
+        break;
+    }
+
+    case 9:
+    {
+        // C_WRITESTR: output string pointed by DE terminated with '$'
+        for(uint16_t address = cpu.mainBank.de.value; cpu.memory->peek(address) != '$'; address++)
+            console.put((char)cpu.memory->peek(address));
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    // RET
+    uint16_t low = cpu.memory->peek(cpu.sp.value++);
+    uint16_t high = cpu.memory->peek(cpu.sp.value++);
+    cpu.pc.value = low + (high << 8);
+}
+
+} // namespace
+
+//-------------------------------------------------------------------------
+// Main
+//-------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s <file.com> [max instructions]\n", argv[0]);
+        return 2;
+    }
+
+    uint64_t maxInstructions = argc > 2 ? std::strtoull(argv[2], nullptr, 0) : 0;
+
+    CPU cpu(0x10000);
+    if(!loadCOM(cpu, argv[1]))
+    {
+        std::fprintf(stderr, "cannot load %s\n", argv[1]);
+        return 2;
+    }
+
+    // Warm boot vector, BDOS entry and top of memory
+    cpu.memory->poke(0x0000, 0x76);     // HALT
+    cpu.memory->poke(BDOS_ENTRY, 0xC9); // RET
+    cpu.memory->poke(BDOS_ENTRY + 1, BDOS_TOP & 0xFF);
+    cpu.memory->poke(BDOS_ENTRY + 2, BDOS_TOP >> 8);
+    cpu.setpc(TPA_START);
+    cpu.sp.value = BDOS_TOP;
+
+    Console console;
+    uint64_t instructions = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    while(cpu.pc.value != 0x0000)
+    {
+        if(cpu.pc.value == BDOS_ENTRY)
+        {
+            bdos(cpu, console);
+            continue;
+        }
+
+        cpu.execute();
+        instructions++;
+
+        if(maxInstructions != 0 && instructions >= maxInstructions)
+        {
+            std::printf("\ninstruction limit reached\n");
+            console.failed++;
+            break;
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = elapsed.count();
+
+    std::printf("\n%d groups passed, %d groups failed\n", console.passed, console.failed);
+    std::printf("%llu instructions, %llu cycles in %.3f s (%.2f MIPS)\n",
+                (unsigned long long)instructions, (unsigned long long)cpu.getClockCycles(),
+                seconds, seconds > 0 ? instructions / seconds / 1e6 : 0.0);
+
+    return (console.failed == 0 && console.passed > 0) ? 0 : 1;
+}